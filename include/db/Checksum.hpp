@@ -0,0 +1,16 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace db {
+
+// CRC32C (полином Кастаньоли). На x86-64 с SSE4.2 считается инструкцией crc32,
+// иначе по таблице. crc - значение для предыдущих данных при счете по частям.
+[[nodiscard]] uint32_t crc32c(const void* data, size_t size, uint32_t crc = 0) noexcept;
+
+[[nodiscard]] inline uint32_t crc32c(std::string_view data) noexcept {
+    return crc32c(data.data(), data.size());
+}
+
+}
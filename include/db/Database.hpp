@@ -15,6 +15,8 @@ public:
 
     void create_table(std::string_view table_name, const std::vector<std::string>& columns, const std::vector<std::string>& types, const std::vector<ForeignKey>& foreign_keys = {});
     void drop_table(std::string_view table_name);
+    // Добавляет таблицу, загруженную из снимка
+    void add_table(Table table);
 
     [[nodiscard]] const Table* get_table(std::string_view table_name) const noexcept;
     [[nodiscard]] Table* get_table(std::string_view table_name) noexcept;
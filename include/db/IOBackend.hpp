@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace db {
+
+enum class IOBackendKind { AUTO, URING, POSIX };
+
+struct IOOptions {
+    // AUTO - io_uring, если ядро его поддерживает, иначе pread/pwrite
+    IOBackendKind kind = IOBackendKind::AUTO;
+    // Файлы снимка пишутся и читаются мимо страничного кэша (только io_uring)
+    bool direct = false;
+};
+
+// Файловый ввод-вывод снимков и журнала. Один объект используется одним потоком.
+class IOBackend {
+public:
+    virtual ~IOBackend() = default;
+
+    [[nodiscard]] virtual std::string_view name() const noexcept = 0;
+
+    // Ставит в очередь запись файла целиком и его fsync. Пока запись идет,
+    // вызывающий может готовить следующий файл; итог сообщает wait().
+    virtual void write_file(std::string path, std::string data) = 0;
+    // Дожидается всех поставленных записей; false, если хотя бы одна не удалась
+    [[nodiscard]] virtual bool wait() = 0;
+
+    // Читает файл частями по порядку и передает каждую в consume, как только она
+    // прочитана; false от consume прерывает чтение
+    [[nodiscard]] virtual bool read_file(const std::string& path,
+                                         const std::function<bool(std::string_view)>& consume) = 0;
+
+    // Дописывает данные в файл, открытый с O_APPEND, и выполняет fdatasync
+    [[nodiscard]] virtual bool append_sync(int fd, std::string_view data) = 0;
+};
+
+// Настройки, с которыми make_io_backend создает новые объекты
+class IOConfig {
+public:
+    [[nodiscard]] static IOOptions get() noexcept {
+        return {kind_.load(std::memory_order_relaxed), direct_.load(std::memory_order_relaxed)};
+    }
+    static void set(const IOOptions& options) noexcept {
+        kind_.store(options.kind, std::memory_order_relaxed);
+        direct_.store(options.direct, std::memory_order_relaxed);
+    }
+
+private:
+    static inline std::atomic<IOBackendKind> kind_{IOBackendKind::AUTO};
+    static inline std::atomic<bool> direct_{false};
+};
+
+// Если io_uring недоступен, возвращает pread/pwrite даже при явном URING
+[[nodiscard]] std::unique_ptr<IOBackend> make_io_backend(const IOOptions& options = IOConfig::get());
+
+}
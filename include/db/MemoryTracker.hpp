@@ -0,0 +1,41 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include "db/Row.hpp"
+
+namespace db {
+
+// Память строки вне ее ячейки в сегменте: вектор значений и строки,
+// не поместившиеся во встроенный буфер std::string
+struct RowMemory {
+    size_t values = 0;
+    size_t strings = 0;
+
+    [[nodiscard]] size_t total() const noexcept { return values + strings; }
+};
+
+[[nodiscard]] RowMemory row_memory(const Row& row) noexcept;
+
+// Память всех таблиц процесса и предел, после которого записи отклоняются.
+// Учет ведут таблицы; предел проверяют операторы до изменения данных.
+class MemoryTracker {
+public:
+    static void add(size_t bytes) noexcept { used_.fetch_add(bytes, std::memory_order_relaxed); }
+    static void release(size_t bytes) noexcept { used_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+    [[nodiscard]] static size_t used() noexcept { return used_.load(std::memory_order_relaxed); }
+    // 0 - предел не задан
+    [[nodiscard]] static size_t limit() noexcept { return limit_.load(std::memory_order_relaxed); }
+    static void set_limit(size_t bytes) noexcept { limit_.store(bytes, std::memory_order_relaxed); }
+
+    [[nodiscard]] static bool can_allocate(size_t bytes) noexcept {
+        const size_t max = limit();
+        return max == 0 || used() + bytes <= max;
+    }
+
+private:
+    static inline std::atomic<size_t> used_{0};
+    static inline std::atomic<size_t> limit_{0};
+};
+
+}
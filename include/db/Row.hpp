@@ -1,4 +1,7 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <vector>
 #include <string>
 #include <variant>
@@ -14,19 +17,47 @@ struct NullValue {
 };
 using Value = std::variant<int, float, std::string, bool, NullValue>;
 
+// Номер версии данных: строка видна снимку s, если begin <= s < end
+using Version = uint64_t;
+constexpr Version kMaxVersion = std::numeric_limits<Version>::max();
+// Штамп незавершенной транзакции: больше любого снимка, поэтому ее записи
+// не видны другим сессиям до COMMIT
+constexpr Version kProvisionalVersion = Version(1) << 63;
+
 class Row {
 public:
     Row() = default;
     explicit Row(std::vector<Value> values) : values_(std::move(values)) {}
+    Row(const Row& other);
+    Row(Row&& other) noexcept;
+    Row& operator=(const Row& other);
+    Row& operator=(Row&& other) noexcept;
 
     const std::vector<Value>& get_values() const noexcept { return values_; }
     std::vector<Value>& get_values() noexcept { return values_; }
 
+    // Штампы версии не входят в значение строки и меняются у опубликованных строк
+    Version get_begin() const noexcept { return begin_.load(std::memory_order_acquire); }
+    Version get_end() const noexcept { return end_.load(std::memory_order_acquire); }
+    void set_begin(Version version) const noexcept { begin_.store(version, std::memory_order_release); }
+    void set_end(Version version) const noexcept { end_.store(version, std::memory_order_release); }
+
+    // own - штамп транзакции, чьи собственные изменения видны независимо от снимка
+    bool is_visible(Version snapshot, Version own = 0) const noexcept {
+        Version begin = get_begin();
+        Version end = get_end();
+        return (begin <= snapshot || begin == own) && snapshot < end && end != own;
+    }
+    bool is_current() const noexcept { return get_end() == kMaxVersion; }
+    bool is_committed() const noexcept { return get_begin() < kProvisionalVersion; }
+
     friend void to_json(json& j, const Row& r);
     friend void from_json(const json& j, Row& r);
 
 private:
     std::vector<Value> values_;
+    mutable std::atomic<Version> begin_{0};
+    mutable std::atomic<Version> end_{kMaxVersion};
 };
 
 void to_json(json& j, const Row& r);
@@ -0,0 +1,49 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace db {
+
+// Получает уведомления, когда поток начинает и заканчивает ждать RwLock.
+// Вызывается, только если блокировку нельзя взять сразу.
+class LockWaitObserver {
+public:
+    virtual void wait_started() = 0;
+    virtual void wait_finished() = 0;
+
+protected:
+    ~LockWaitObserver() = default;
+};
+
+// Блокировка читателей/писателей, не привязанная к потоку: транзакция
+// удерживает ее между операторами, которые выполняются на разных потоках.
+// Ожидающий писатель не пропускает новых читателей.
+class RwLock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Наблюдатель ожиданий для вызывающего потока; nullptr - без уведомлений
+    static void set_wait_observer(LockWaitObserver* observer) noexcept;
+
+    void lock();
+    bool try_lock();
+    bool try_lock_until(Clock::time_point deadline);
+    void unlock();
+
+    void lock_shared();
+    bool try_lock_shared_until(Clock::time_point deadline);
+    void unlock_shared();
+
+private:
+    bool can_lock() const noexcept { return !writer_ && readers_ == 0; }
+    bool can_lock_shared() const noexcept { return !writer_ && waiting_writers_ == 0; }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t readers_ = 0;
+    size_t waiting_writers_ = 0;
+    bool writer_ = false;
+};
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "db/Row.hpp"
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace db {
+
+class Table;
+
+// Оценка числа различных значений по 2^kPrecisionBits регистрам
+// (Flajolet и др., HyperLogLog); погрешность около 1.04 / sqrt(2^p)
+class HyperLogLog {
+public:
+    static constexpr unsigned kPrecisionBits = 12;
+    static constexpr size_t kRegisters = size_t(1) << kPrecisionBits;
+
+    void add(uint64_t hash) noexcept;
+    [[nodiscard]] double estimate() const noexcept;
+
+private:
+    std::array<uint8_t, kRegisters> registers_{};
+};
+
+struct ColumnStatistics {
+    double null_fraction = 0;
+    double distinct = 0;
+    // Границы гистограммы равной глубины: между соседними границами
+    // лежит примерно одинаковая доля непустых значений
+    std::vector<Value> histogram;
+};
+
+struct TableStatistics {
+    size_t row_count = 0;
+    std::vector<ColumnStatistics> columns;
+};
+
+// Статистика по текущим зафиксированным строкам таблицы. Различные значения
+// считаются по всем строкам, гистограмма строится по случайной выборке.
+[[nodiscard]] TableStatistics collect_statistics(const Table& table);
+
+// Доля измененных строк, после которой статистика собирается заново
+class AutoAnalyze {
+public:
+    static constexpr size_t kMinChangedRows = 50;
+
+    [[nodiscard]] static double fraction() noexcept { return fraction_; }
+    // Отрицательное значение выключает автоматический сбор
+    static void set_fraction(double fraction) noexcept { fraction_ = fraction; }
+
+private:
+    static inline double fraction_ = 0.1;
+};
+
+void to_json(json& j, const ColumnStatistics& stats);
+void from_json(const json& j, ColumnStatistics& stats);
+void to_json(json& j, const TableStatistics& stats);
+void from_json(const json& j, TableStatistics& stats);
+
+}
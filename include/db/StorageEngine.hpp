@@ -1,15 +1,20 @@
 #pragma once
+#include <cstdint>
 #include <unordered_map>
 #include <string>
 #include <string_view>
 #include <optional>
 #include "db/Database.hpp"
+#include "db/VersionManager.hpp"
+#include "db/RwLock.hpp"
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
 namespace db {
 
+class WriteAheadLog;
+
 class StorageEngine {
 public:
     StorageEngine() = default;
@@ -22,11 +27,26 @@ public:
 
     const std::unordered_map<std::string, Database>& get_databases() const noexcept { return databases_; }
 
+    uint64_t get_schema_version() const noexcept { return schema_version_; }
+    void bump_schema_version() noexcept { ++schema_version_; }
+
+    // Защищает набор баз и таблиц и их схемы
+    RwLock& get_catalog_lock() const noexcept { return catalog_lock_; }
+    VersionManager& get_versions() const noexcept { return versions_; }
+
+    // Журнал подтвержденных транзакций, если сервер работает в режиме durability
+    WriteAheadLog* get_wal() const noexcept { return wal_; }
+    void set_wal(WriteAheadLog* wal) noexcept { wal_ = wal; }
+
     friend void to_json(json& j, const StorageEngine& e);
     friend void from_json(const json& j, StorageEngine& e);
 
 private:
     std::unordered_map<std::string, Database> databases_;
+    uint64_t schema_version_ = 0;
+    mutable RwLock catalog_lock_;
+    mutable VersionManager versions_;
+    WriteAheadLog* wal_ = nullptr;
 };
 
 void to_json(json& j, const StorageEngine& engine);
@@ -1,8 +1,29 @@
 #pragma once
 #include "db/StorageEngine.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace db {
-    bool save_to_file(const StorageEngine& engine, std::string_view path);
-    bool load_from_file(StorageEngine& engine, std::string_view path);
+    // Таблица, загруженная из снимка, и время ее чтения
+    struct LoadedTableInfo {
+        std::string database;
+        std::string table;
+        size_t rows = 0;
+        std::chrono::milliseconds elapsed{0};
+    };
+
+    // Снимок - манифест по пути path и файлы таблиц в каталоге path + ".tables".
+    // Сохранение переписывает только таблицы, измененные после прошлого снимка,
+    // и атомарно подменяет манифест; предыдущий манифест остается в path + ".prev".
+    // Файлы разбиты на блоки с CRC32C. Загрузка понимает и прежний единый файл.
+    // wal_lsn - номер последней записи журнала, изменения которой вошли в снимок.
+    bool save_to_file(const StorageEngine& engine, std::string_view path, uint64_t wal_lsn = 0);
+    // false - снимка нет; если поврежден и он, и запасной, бросает std::runtime_error.
+    // В wal_lsn возвращается номер записи журнала, сохраненный в загруженном снимке,
+    // в tables - загруженные таблицы в порядке манифеста.
+    bool load_from_file(StorageEngine& engine, std::string_view path, uint64_t* wal_lsn = nullptr,
+                        std::vector<LoadedTableInfo>* tables = nullptr);
 }
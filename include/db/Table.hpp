@@ -1,22 +1,38 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <memory>
+#include <span>
+#include <mutex>
+#include <iterator>
 #include <string_view>
 #include "db/Row.hpp"
+#include "db/RwLock.hpp"
+#include "db/Statistics.hpp"
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
 namespace db {
 
+// Что происходит со ссылающимися строками при удалении строки или изменении ключа
+enum class ForeignKeyAction { RESTRICT, CASCADE, SET_NULL };
+
+std::string_view foreign_key_action_name(ForeignKeyAction action) noexcept;
+
 struct ForeignKey {
     std::string column_name;
     std::string referenced_table;
     std::string referenced_column;
+    ForeignKeyAction on_delete = ForeignKeyAction::RESTRICT;
+    ForeignKeyAction on_update = ForeignKeyAction::RESTRICT;
     
     ForeignKey() = default;
-    ForeignKey(std::string col, std::string ref_table, std::string ref_col)
-        : column_name(std::move(col)), referenced_table(std::move(ref_table)), referenced_column(std::move(ref_col)) {}
+    ForeignKey(std::string col, std::string ref_table, std::string ref_col,
+               ForeignKeyAction delete_action = ForeignKeyAction::RESTRICT,
+               ForeignKeyAction update_action = ForeignKeyAction::RESTRICT)
+        : column_name(std::move(col)), referenced_table(std::move(ref_table)), referenced_column(std::move(ref_col)),
+          on_delete(delete_action), on_update(update_action) {}
     
     friend void to_json(json& j, const ForeignKey& fk);
     friend void from_json(const json& j, ForeignKey& fk);
@@ -50,25 +66,170 @@ private:
 void to_json(json& j, const Column& c);
 void from_json(const json& j, Column& c);
 
+// Сегмент хранилища строк. Опубликованные строки не перемещаются,
+// поэтому читатели обходят их без блокировок, пока писатель дописывает новые.
+struct RowChunk {
+    explicit RowChunk(size_t capacity) : rows(std::make_unique<Row[]>(capacity)), capacity(capacity) {}
+
+    std::unique_ptr<Row[]> rows;
+    size_t capacity;
+    std::atomic<size_t> size{0};
+};
+
+using ChunkList = std::vector<std::shared_ptr<RowChunk>>;
+
+// Все версии строк таблицы на момент вызова Table::scan()
+class RowRange {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Row*;
+        using reference = const Row&;
+
+        Iterator() = default;
+        Iterator(const RowRange* range, size_t chunk) : range_(range), chunk_(chunk) {}
+
+        reference operator*() const { return (*range_->chunks_)[chunk_]->rows[index_]; }
+        pointer operator->() const { return &**this; }
+        Iterator& operator++() {
+            if (++index_ == range_->chunk_size(chunk_)) {
+                ++chunk_;
+                index_ = 0;
+            }
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+        bool operator==(const Iterator& other) const noexcept { return chunk_ == other.chunk_ && index_ == other.index_; }
+        bool operator!=(const Iterator& other) const noexcept { return !(*this == other); }
+
+    private:
+        const RowRange* range_ = nullptr;
+        size_t chunk_ = 0;
+        size_t index_ = 0;
+    };
+
+    explicit RowRange(std::shared_ptr<const ChunkList> chunks);
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, chunks_->size()); }
+    size_t size() const noexcept { return size_; }
+    size_t chunk_count() const noexcept { return chunks_->size(); }
+
+private:
+    size_t chunk_size(size_t chunk) const noexcept;
+
+    std::shared_ptr<const ChunkList> chunks_;
+    size_t last_size_ = 0;
+    size_t size_ = 0;
+};
+
+// Память таблицы в байтах: rows - ячейки сегментов и векторы значений,
+// strings - длинные строки. dead - часть памяти, занятая закрытыми
+// версиями строк, которую освободит сборка мусора.
+struct TableMemory {
+    size_t rows = 0;
+    size_t strings = 0;
+    size_t dead = 0;
+
+    [[nodiscard]] size_t total() const noexcept { return rows + strings; }
+};
+
 class Table {
 public:
     Table() = default;
     Table(std::string name, const std::vector<std::string>& column_names, const std::vector<std::string>& column_types, const std::vector<ForeignKey>& foreign_keys = {});
 
+    // Изменяющие методы вызываются только под эксклюзивной блокировкой таблицы
     void insert(const Row& row);
+    void insert(Row&& row);
+    // Строки переносятся в таблицу; перемещенные остаются у вызывающего
+    void insert_rows(std::span<Row> rows, Version version = 0, std::vector<const Row*>* placed = nullptr);
+    void retire(const Row& row, Version version);
+    // Откат изменений незавершенной транзакции
+    void restore(const Row& row);
+    void discard(const Row& row);
+
+    [[nodiscard]] bool needs_garbage_collection() const noexcept;
+    size_t collect_garbage(Version horizon);
+
+    [[nodiscard]] int find_column(std::string_view column_name) const noexcept;
 
     const std::string& get_name() const noexcept { return name_; }
     const std::vector<Column>& get_columns() const noexcept { return columns_; }
-    const std::vector<Row>& get_rows() const noexcept { return rows_; }
-    std::vector<Row>& get_rows() noexcept { return rows_; }
+    [[nodiscard]] RowRange scan() const;
+
+    // Читаются без блокировки таблицы (EXPLAIN, SHOW MEMORY)
+    size_t get_version_count() const noexcept { return versions_->total.load(std::memory_order_relaxed); }
+    size_t get_dead_version_count() const noexcept { return versions_->dead.load(std::memory_order_relaxed); }
+    // Читается без блокировки таблицы
+    [[nodiscard]] TableMemory get_memory() const noexcept;
+
+    // Статистика последнего ANALYZE; nullptr, если таблица не анализировалась
+    [[nodiscard]] std::shared_ptr<const TableStatistics> get_statistics() const;
+    void set_statistics(TableStatistics statistics);
+    // С последнего ANALYZE изменилась заданная AutoAnalyze доля строк
+    [[nodiscard]] bool needs_analyze() const noexcept;
+
+    // Версия последней фиксации, изменившей строки таблицы. Результат чтения
+    // по снимку s остается верным, пока get_last_commit() <= s.
+    [[nodiscard]] Version get_last_commit() const noexcept;
+    void mark_committed(Version version) noexcept;
+
+    // Таблица изменилась после последнего сохранения в снимок; флаг сбрасывается.
+    // Новая таблица считается измененной, загруженная из снимка - нет.
+    [[nodiscard]] bool take_dirty() const noexcept;
+    void mark_dirty() const noexcept;
+
+    // Блокировка писателей таблицы на время оператора или транзакции
+    RwLock& get_lock() const noexcept { return *lock_; }
 
     friend void to_json(json& j, const Table& t);
     friend void from_json(const json& j, Table& t);
 
 private:
+    // Счетчики памяти; при уничтожении таблицы ее память возвращается в MemoryTracker
+    struct MemoryCounters {
+        std::atomic<size_t> rows{0};
+        std::atomic<size_t> strings{0};
+        std::atomic<size_t> dead{0};
+
+        ~MemoryCounters();
+        void add(size_t row_bytes, size_t string_bytes) noexcept;
+        void reset(const TableMemory& memory) noexcept;
+    };
+
+    // Изменения строк: с последнего сбора статистики, последняя фиксация
+    // и признак изменений, еще не сохраненных в снимок
+    struct ChangeCounters {
+        std::atomic<size_t> changed_rows{0};
+        std::atomic<size_t> analyzed_rows{0};
+        std::atomic<Version> last_commit{0};
+        std::atomic<bool> dirty{true};
+    };
+
+    // Версии строк в сегментах и мертвые среди них; меняются под блокировкой таблицы
+    struct VersionCounters {
+        std::atomic<size_t> total{0};
+        std::atomic<size_t> dead{0};
+    };
+
     std::string name_;
     std::vector<Column> columns_;
-    std::vector<Row> rows_;
+    std::shared_ptr<const ChunkList> chunks_ = std::make_shared<ChunkList>();
+    // Защищает публикацию списка сегментов и статистики
+    std::unique_ptr<std::mutex> chunks_mutex_ = std::make_unique<std::mutex>();
+    std::shared_ptr<const TableStatistics> statistics_;
+    std::unique_ptr<ChangeCounters> changes_ = std::make_unique<ChangeCounters>();
+    std::unique_ptr<VersionCounters> versions_ = std::make_unique<VersionCounters>();
+    std::unique_ptr<MemoryCounters> memory_ = std::make_unique<MemoryCounters>();
+    std::unique_ptr<RwLock> lock_ = std::make_unique<RwLock>();
 };
 
 void to_json(json& j, const Table& t);
@@ -0,0 +1,109 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "db/Table.hpp"
+#include "db/RwLock.hpp"
+#include "db/VersionManager.hpp"
+
+namespace db {
+
+class WriteAheadLog;
+
+// Ошибка COMMIT, когда запись фиксации не удалось сбросить в WAL
+inline constexpr std::string_view kUnknownCommitOutcome =
+    "Commit outcome unknown: the commit record could not be flushed to the WAL, "
+    "the changes are visible but may be lost on restart; further commits are rejected";
+
+// Фиксация, ответ на которую ждет сброса записи в WAL. Пока version жива,
+// версия фиксации не завершена и снимки не видят изменений, как и при ожидании
+// внутри commit. sequence == 0 - ждать нечего.
+struct PendingCommit {
+    uint64_t sequence = 0;
+    std::shared_ptr<WriteVersion> version;
+};
+
+struct TableLockRequest {
+    RwLock* lock;
+    bool exclusive;
+};
+
+// Изменения транзакции сразу попадают в таблицы с временным штампом и
+// записываются в журнал отката. COMMIT заменяет штампы версией фиксации
+// одной записью в WAL, ROLLBACK возвращает строкам прежние штампы.
+class Transaction {
+public:
+    explicit Transaction(VersionManager& versions);
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    Version get_stamp() const noexcept { return stamp_; }
+
+    // Блокировки удерживаются до COMMIT/ROLLBACK. Уже взятая блокировка
+    // повторно не захватывается и не повышается до эксклюзивной.
+    void hold_catalog(RwLock& catalog);
+    bool lock_tables(const std::vector<TableLockRequest>& locks, RwLock::Clock::time_point deadline);
+
+    void insert_rows(const std::string& database, Table& table, std::span<Row> rows);
+    void retire(const std::string& database, Table& table, const Row& row);
+    // Сборка мусора в таблице до изменения, если не хватает памяти. Таблицы,
+    // уже измененные транзакцией, не трогаются: журнал отката ссылается на
+    // их строки. Возвращает true, если сборка выполнялась.
+    bool reclaim(Table& table);
+
+    size_t get_savepoint() const noexcept { return undo_.size(); }
+    void rollback_to(size_t savepoint);
+    void rollback();
+    // С pending сброс записи в WAL не ожидается: вызывающий дожидается его
+    // через WriteAheadLog и после этого освобождает pending
+    bool commit(WriteAheadLog* wal, std::string& error, PendingCommit* pending = nullptr);
+
+private:
+    struct UndoEntry {
+        Table* table;
+        const Row* row;
+        bool inserted;
+    };
+
+    json make_redo_record(Version version) const;
+    // Сборка мусора и автоматический ANALYZE измененных таблиц после фиксации,
+    // когда блокировки таблиц и версия фиксации уже отпущены. Каталог еще
+    // удерживается, поэтому таблицы не удаляются. Статистика, как в ANALYZE,
+    // собирается без блокировки таблицы; сборка мусора перестраивает сегменты
+    // и выполняется, только если эксклюзивную блокировку можно взять сразу.
+    void maintain(const std::vector<Table*>& tables);
+    void release_tables();
+    void release();
+
+    VersionManager& versions_;
+    Version stamp_;
+    std::vector<UndoEntry> undo_;
+    std::unordered_map<Table*, std::string> databases_;
+    std::shared_lock<RwLock> catalog_;
+    std::vector<std::unique_lock<RwLock>> exclusive_locks_;
+    std::vector<std::shared_lock<RwLock>> shared_locks_;
+    std::unordered_set<const RwLock*> held_;
+    bool finished_ = false;
+};
+
+// Версии и транзакция, с которыми выполняется один оператор
+struct StatementVersion {
+    Version snapshot = 0;
+    Transaction* transaction = nullptr;
+
+    [[nodiscard]] bool is_visible(const Row& row) const noexcept {
+        return row.is_visible(snapshot, transaction ? transaction->get_stamp() : 0);
+    }
+};
+
+}
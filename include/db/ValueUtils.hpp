@@ -7,5 +7,14 @@ namespace db {
 std::string value_to_string(const Value& v);
 bool value_equals(const Value& a, const Value& b) noexcept;
 bool value_less(const Value& a, const Value& b) noexcept;
+size_t value_hash(const Value& v) noexcept;
 
-}
\ No newline at end of file
+struct ValueHash {
+    size_t operator()(const Value& v) const noexcept { return value_hash(v); }
+};
+
+struct ValueEqual {
+    bool operator()(const Value& a, const Value& b) const noexcept { return value_equals(a, b); }
+};
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <set>
+#include "db/Row.hpp"
+
+namespace db {
+
+// Раздает версии пишущим операторам и снимки читающим.
+// Снимок не видит ни одной незавершенной записи: он равен версии,
+// предшествующей самой ранней из выполняющихся записей.
+class VersionManager {
+public:
+    // Штамп, которым транзакция помечает свои изменения до COMMIT
+    Version begin_transaction() noexcept;
+
+    Version begin_write();
+    void end_write(Version version);
+
+    Version acquire_snapshot();
+    void release_snapshot(Version snapshot);
+
+    // Версии, закрытые не позже этой, не видны ни одному снимку
+    [[nodiscard]] Version get_horizon() const;
+
+private:
+    Version current_snapshot() const;
+
+    mutable std::mutex mutex_;
+    Version clock_ = 0;
+    std::atomic<Version> next_transaction_{1};
+    std::set<Version> in_flight_;
+    std::multiset<Version> snapshots_;
+};
+
+class WriteVersion {
+public:
+    explicit WriteVersion(VersionManager& versions) : versions_(versions), version_(versions.begin_write()) {}
+    ~WriteVersion() { versions_.end_write(version_); }
+
+    WriteVersion(const WriteVersion&) = delete;
+    WriteVersion& operator=(const WriteVersion&) = delete;
+
+    Version get() const noexcept { return version_; }
+
+private:
+    VersionManager& versions_;
+    Version version_;
+};
+
+class Snapshot {
+public:
+    explicit Snapshot(VersionManager& versions) : versions_(versions), version_(versions.acquire_snapshot()) {}
+    ~Snapshot() { versions_.release_snapshot(version_); }
+
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    Version get() const noexcept { return version_; }
+
+private:
+    VersionManager& versions_;
+    Version version_;
+};
+
+}
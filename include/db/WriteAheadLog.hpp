@@ -0,0 +1,90 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "db/StorageEngine.hpp"
+#include "db/IOBackend.hpp"
+
+using json = nlohmann::json;
+
+namespace db {
+
+struct WalOptions {
+    // Сколько поток сброса ждет новые записи, прежде чем сбросить неполную группу
+    std::chrono::microseconds max_delay{0};
+    // Размер группы, при котором она сбрасывается не дожидаясь max_delay
+    size_t batch_size = 256;
+    // COMMIT подтверждается до fsync: при сбое теряются последние транзакции,
+    // но порядок записей в журнале сохраняется
+    bool relaxed = false;
+};
+
+// Журнал упреждающей записи: одна строка JSON с CRC32C на подтвержденную транзакцию.
+// Записи нумеруются по возрастанию, номер продолжается после перезапуска; снимок
+// хранит номер последней вошедшей в него записи, и восстановление пропускает
+// записи до него, даже если журнал не успели очистить после сохранения снимка.
+// Записи конкурирующих сессий копятся в очереди, и отдельный поток сбрасывает
+// их группой: один write и один fdatasync на всех ожидающих.
+class WriteAheadLog {
+public:
+    WriteAheadLog(std::string snapshot_path, std::string log_path, WalOptions options = {});
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    bool open();
+    void close();
+
+    // Ставит запись в очередь и возвращает ее номер в журнале (0 - журнал недоступен).
+    // Сбой записи необратим: после него журнал отклоняет все новые записи
+    uint64_t enqueue(const json& record);
+    // Дожидается сброса записи на диск; в relaxed-режиме возвращается сразу
+    bool wait_durable(uint64_t sequence);
+    // То же без ожидания: callback получает результат wait_durable. Вызывается сразу,
+    // если ответ уже известен, иначе потоком сброса, без блокировки журнала
+    void on_durable(uint64_t sequence, std::function<void(bool)> callback);
+    bool append(const json& record) { return wait_durable(enqueue(record)); }
+
+    // Сохраняет снимок и очищает журнал; вызывается, когда нет незавершенных записей.
+    // Перед этим дожидается сброса всей очереди. Если снимок сохранить не удалось,
+    // журнал, как после сбоя записи, больше не принимает фиксаций.
+    bool checkpoint(const StorageEngine& engine);
+
+    // Применяет к загруженному снимку записи журнала с номерами после snapshot_lsn,
+    // возвращает их число. Вызывается до open(): следующие записи продолжают нумерацию.
+    size_t recover(StorageEngine& engine, uint64_t snapshot_lsn);
+
+    const std::string& get_log_path() const noexcept { return log_path_; }
+
+private:
+    void flush_loop();
+    bool wait_flushed(std::unique_lock<std::mutex>& lock, uint64_t sequence);
+    void complete_waiters(std::unique_lock<std::mutex>& lock);
+
+    std::string snapshot_path_;
+    std::string log_path_;
+    WalOptions options_;
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable flushed_;
+    std::vector<std::string> pending_;
+    std::vector<std::pair<uint64_t, std::function<void(bool)>>> waiters_;
+    uint64_t appended_ = 0;
+    uint64_t flushed_sequence_ = 0;
+    bool failed_ = false;
+    bool stopping_ = false;
+    int fd_ = -1;
+    // Используется только потоком сброса
+    std::unique_ptr<IOBackend> io_;
+    std::thread flusher_;
+};
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace metrics {
+
+// Гистограмма в духе HdrHistogram: логарифмические диапазоны, каждый делится
+// на линейные корзины, поэтому относительная погрешность любого значения
+// не больше 2/kSubBuckets (~1.6%). Значения от 0 до 2^kMaxBits - 1,
+// большие попадают в последнюю корзину. Запись - одно атомарное сложение,
+// чтение допускается параллельно с записью.
+class Histogram {
+public:
+    static constexpr unsigned kSubBucketBits = 7;
+    static constexpr unsigned kMaxBits = 40;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = kSubBuckets + (kMaxBits - kSubBucketBits) * (kSubBuckets / 2);
+
+    Histogram() = default;
+    Histogram(const Histogram& other) { merge(other); }
+    Histogram& operator=(const Histogram& other);
+
+    void record(uint64_t value, uint64_t count = 1) noexcept;
+    void merge(const Histogram& other) noexcept;
+    void reset() noexcept;
+
+    [[nodiscard]] uint64_t count() const noexcept;
+    [[nodiscard]] uint64_t max() const noexcept { return max_.load(std::memory_order_relaxed); }
+    [[nodiscard]] double mean() const noexcept;
+    // Наибольшее значение, эквивалентное корзине, где накопленная доля достигает percentile (0..100)
+    [[nodiscard]] uint64_t percentile(double percentile) const noexcept;
+
+private:
+    static size_t index_of(uint64_t value) noexcept;
+    static uint64_t highest_equivalent(size_t index) noexcept;
+
+    std::array<std::atomic<uint64_t>, kBucketCount> counts_{};
+    std::atomic<uint64_t> total_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+}
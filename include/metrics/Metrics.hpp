@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "metrics/Histogram.hpp"
+
+namespace metrics {
+
+constexpr size_t kShards = 16;
+constexpr size_t kMaxStatementKinds = 32;
+
+// Счетчик из ячеек на отдельных кэш-линиях: потоки увеличивают разные
+// ячейки и не конкурируют за одну, значение - сумма ячеек
+class Counter {
+public:
+    void add(uint64_t n = 1) noexcept;
+    [[nodiscard]] uint64_t value() const noexcept;
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Cell, kShards> cells_;
+};
+
+// Один выполненный оператор; kind - индекс вида оператора (< kMaxStatementKinds)
+struct StatementSample {
+    size_t kind;
+    bool ok;
+    uint64_t parse_us;
+    uint64_t execute_us;
+    uint64_t rows_scanned;
+    uint64_t rows_returned;
+};
+
+// Показатели одного вида операторов, сведенные по всем потокам
+struct StatementTotals {
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t rows_scanned = 0;
+    uint64_t rows_returned = 0;
+    Histogram parse_us;
+    Histogram execute_us;
+};
+
+struct ServerTotals {
+    uint64_t connections_opened = 0;
+    uint64_t connections_closed = 0;
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+};
+
+// Запись идет в область текущего потока, которая создается при первом
+// обращении; чтение сводит области всех потоков, а область завершившегося
+// потока переносится в общий итог и освобождается
+void record_statement(const StatementSample& sample) noexcept;
+[[nodiscard]] std::vector<StatementTotals> collect_statements();
+
+void connection_opened() noexcept;
+void connection_closed() noexcept;
+void add_bytes_received(uint64_t bytes) noexcept;
+void add_bytes_sent(uint64_t bytes) noexcept;
+[[nodiscard]] ServerTotals collect_server();
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace metrics {
+
+// Оператор, выполнявшийся дольше порога журнала медленных запросов
+struct SlowQuery {
+    std::string query;
+    std::string database;
+    std::chrono::system_clock::time_point finished;
+    uint64_t parse_us = 0;
+    uint64_t execute_us = 0;
+    uint64_t rows_scanned = 0;
+    uint64_t rows_returned = 0;
+    bool ok = true;
+};
+
+// Сводка по одному отпечатку среди медленных запросов
+struct QueryAggregate {
+    std::string fingerprint;
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    uint64_t rows_scanned = 0;
+};
+
+struct SlowLogOptions {
+    // Пустой путь - только сводка в памяти, без файла
+    std::string path;
+    std::chrono::microseconds threshold{100000};
+};
+
+// Текст запроса без литералов: строки, числа и TRUE/FALSE заменяются на '?',
+// пробелы схлопываются, поэтому запросы с разными константами совпадают
+[[nodiscard]] std::string fingerprint(std::string_view query);
+
+// Запускает фоновый поток, который забирает записи из кольцевого буфера,
+// пишет их в файл строками JSON и обновляет сводку по отпечаткам.
+// Поток запроса только кладет запись в буфер: при переполнении запись
+// отбрасывается и учитывается в slow_queries_dropped().
+void start_slow_log(const SlowLogOptions& options);
+void stop_slow_log();
+
+[[nodiscard]] bool is_slow(uint64_t total_us) noexcept;
+void log_slow_query(SlowQuery query) noexcept;
+
+[[nodiscard]] std::vector<QueryAggregate> top_queries(size_t limit);
+[[nodiscard]] uint64_t slow_queries_dropped() noexcept;
+
+}
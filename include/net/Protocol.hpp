@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "db/Row.hpp"
+
+namespace net {
+
+// Клиент включает framed-режим, отправив kHandshake сразу после подключения.
+// Кадр: u32 длина (big-endian, тип + данные), u8 тип, данные. Бинарный результат
+// идет несколькими кадрами RESULT_BINARY: заголовок, по кадру на пакет строк
+// и пакет с нулем строк в конце (формат - ResultSet::serialize_binary).
+constexpr std::string_view kHandshake{"SQLF\x01", 5};
+constexpr size_t kFrameHeaderSize = 5;
+constexpr size_t kMaxFrameSize = 64 << 20;
+
+enum class MessageType : uint8_t {
+    QUERY = 'Q',
+    QUERY_BINARY = 'B',
+    PREPARE = 'P',
+    EXECUTE = 'X',
+    OK = 'K',
+    RESULT = 'R',
+    RESULT_BINARY = 'D',
+    ERROR = 'E'
+};
+
+struct Frame {
+    MessageType type;
+    std::string payload;
+};
+
+// PREPARE: имя, '\0', текст запроса.
+// EXECUTE: u8 флаги (бит 0 - бинарный результат), u16 длина имени, имя,
+// u16 число параметров, для каждого u8 тип (0 NULL, 1 INT, 2 FLOAT, 3 BOOL,
+// 4 STR) и значение: 4 байта, 1 байт или u32 длина + байты. Little-endian.
+struct PrepareRequest {
+    std::string name;
+    std::string query;
+};
+
+struct ExecuteRequest {
+    std::string name;
+    std::vector<db::Value> params;
+    bool binary = false;
+};
+
+enum class DecodeStatus {
+    COMPLETE,
+    INCOMPLETE,
+    INVALID
+};
+
+// false, если данные не помещаются в кадр kMaxFrameSize; out тогда не меняется
+[[nodiscard]] bool append_frame(std::string& out, MessageType type, std::string_view payload);
+DecodeStatus decode_frame(std::string_view buffer, Frame& frame, size_t& consumed);
+bool decode_prepare(std::string_view payload, PrepareRequest& request);
+bool decode_execute(std::string_view payload, ExecuteRequest& request);
+// Клиентская сторона: кадры PREPARE и EXECUTE целиком
+[[nodiscard]] bool append_prepare(std::string& out, const PrepareRequest& request);
+[[nodiscard]] bool append_execute(std::string& out, const ExecuteRequest& request);
+
+}
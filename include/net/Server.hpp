@@ -1,3 +1,41 @@
 #pragma once
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+struct ServerConfig {
+    short port = 5555;
+    // Потоки ввода-вывода и столько же потоков выполнения операторов, не считая ждущих блокировок
+    size_t threads = std::thread::hardware_concurrency();
+    size_t max_connections = 1024;
+    // Каждый COMMIT записывается в WAL и сбрасывается на диск до ответа клиенту
+    bool durable = false;
+    // Групповая фиксация: сколько ждать попутные записи и сколько брать за один fsync
+    std::chrono::microseconds wal_max_delay{0};
+    size_t wal_batch_size = 256;
+    // Ответ на COMMIT не ждет fsync; при сбое теряются последние подтвержденные транзакции
+    bool wal_relaxed = false;
+    // Файл, куда периодически выгружаются строки SHOW STATS в виде "имя значение"
+    std::string metrics_file;
+    std::chrono::seconds metrics_interval{10};
+    // Журнал медленных запросов в виде строк JSON; без файла остается только SHOW TOP QUERIES
+    std::string slow_query_file;
+    std::chrono::milliseconds slow_query_threshold{100};
+    // Предел памяти таблиц в байтах: при его достижении INSERT, UPDATE и COPY
+    // завершаются ошибкой; 0 - без предела
+    size_t memory_limit = 0;
+    // Доля измененных строк таблицы, после которой статистика собирается заново;
+    // отрицательное значение выключает автоматический ANALYZE
+    double auto_analyze_fraction = 0.1;
+    // Объем кэша готовых ответов на SELECT вне транзакций в байтах; 0 - кэш выключен
+    size_t result_cache_size = 0;
+    // Ввод-вывод снимков и журнала: "auto", "uring" или "posix"; direct - O_DIRECT для снимков
+    std::string io_backend = "auto";
+    bool io_direct = false;
+    // Каталог для файлов COPY FROM/TO; пустой - COPY запрещен
+    std::string copy_dir;
+};
 
 void run_server(short port);
+void run_server(const ServerConfig& config);
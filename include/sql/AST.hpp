@@ -1,8 +1,10 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include <variant>
 #include "db/Row.hpp"
+#include "db/Table.hpp"
 
 namespace sql {
 
@@ -16,6 +18,16 @@ enum class CommandType {
     UPDATE,
     DELETE,
     USE,
+    COPY,
+    PREPARE,
+    EXECUTE,
+    DEALLOCATE,
+    BEGIN,
+    COMMIT,
+    ROLLBACK,
+    SHOW,
+    EXPLAIN,
+    ANALYZE,
     UNKNOWN
 };
 
@@ -31,6 +43,8 @@ struct ForeignKeyConstraint {
     std::string column_name;
     std::string referenced_table;
     std::string referenced_column;
+    db::ForeignKeyAction on_delete = db::ForeignKeyAction::RESTRICT;
+    db::ForeignKeyAction on_update = db::ForeignKeyAction::RESTRICT;
     
     ForeignKeyConstraint() = default;
     ForeignKeyConstraint(std::string col, std::string ref_table, std::string ref_col)
@@ -53,7 +67,9 @@ struct DropTable {
 struct Insert {
     std::string table_name;
     std::vector<std::string> columns;
-    std::vector<db::Value> values;
+    std::vector<std::vector<db::Value>> rows;
+    // Значение было строкой в кавычках; параллельно rows
+    std::vector<std::vector<bool>> quoted;
 };
 
 struct Select {
@@ -77,6 +93,58 @@ struct Use {
     std::string db_name;
 };
 
+struct Copy {
+    std::string table_name;
+    std::string path;
+    bool from = true;
+    bool header = false;
+};
+
+struct Prepare {
+    std::string name;
+    std::string query;
+};
+
+struct Execute {
+    std::string name;
+    std::vector<db::Value> params;
+};
+
+struct Deallocate {
+    std::string name;
+};
+
+struct Begin {};
+
+struct Commit {};
+
+struct Rollback {};
+
+enum class ShowTarget {
+    STATS,
+    TOP_QUERIES,
+    MEMORY
+};
+
+struct Show {
+    ShowTarget target;
+    // Сколько строк выводит SHOW TOP QUERIES [N]
+    size_t limit = 10;
+};
+
+// Пустое имя - все таблицы текущей базы
+struct Analyze {
+    std::string table_name;
+};
+
+struct ParseResult;
+
+// Разобранный оператор, план которого выводится
+struct Explain {
+    bool analyze = false;
+    std::shared_ptr<const ParseResult> statement;
+};
+
 using Command = std::variant<
     CreateDatabase,
     DropDatabase,
@@ -86,7 +154,17 @@ using Command = std::variant<
     Select,
     Update,
     Delete,
-    Use
+    Use,
+    Copy,
+    Prepare,
+    Execute,
+    Deallocate,
+    Begin,
+    Commit,
+    Rollback,
+    Show,
+    Explain,
+    Analyze
 >;
 
 struct ParseResult {
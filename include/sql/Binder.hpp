@@ -0,0 +1,41 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <vector>
+#include "sql/Plan.hpp"
+#include "db/Database.hpp"
+
+namespace sql {
+
+// Разрешает имена таблиц и колонок в позиции и проверяет типы констант.
+// В подготовленных запросах '?' и '$N' без кавычек становятся параметрами.
+class Binder {
+public:
+    Binder(const db::Database& db, bool allow_params) : db_(db), allow_params_(allow_params) {}
+
+    bool bind(const ParseResult& pr, BoundStatement& out);
+    bool bind_select(const Select& cmd, BoundSelect& out);
+    bool bind_insert(const Insert& cmd, BoundInsert& out);
+    bool bind_update(const Update& cmd, BoundUpdate& out);
+    bool bind_delete(const Delete& cmd, BoundDelete& out);
+
+    const std::string& get_error() const noexcept { return error_; }
+    // Тип каждого параметра; nullopt - номер параметра пропущен в запросе
+    const std::vector<std::optional<ColumnType>>& get_param_types() const noexcept { return param_types_; }
+
+private:
+    bool bind_where(const std::vector<std::string>& tokens, const db::Table& table, BoundWhere& out);
+    // quoted - значение было строкой в кавычках и параметром не считается
+    // type - тип column, разрешенный вызывающим один раз на колонку
+    bool bind_value(const db::Value& literal, bool quoted, const db::Column& column, ColumnType type, BoundValue& out);
+    const db::Table* find_table(const std::string& name);
+    bool fail(std::string error);
+
+    const db::Database& db_;
+    bool allow_params_;
+    int next_param_ = 0;
+    std::vector<std::optional<ColumnType>> param_types_;
+    std::string error_;
+};
+
+}
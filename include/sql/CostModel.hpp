@@ -0,0 +1,21 @@
+#pragma once
+#include "sql/Plan.hpp"
+#include "db/Table.hpp"
+
+namespace sql {
+
+// Оценки по статистике ANALYZE. Без статистики используются постоянные
+// доли, как в PostgreSQL: условие равенства отбирает 0.5% строк.
+[[nodiscard]] double estimate_selectivity(const Predicate& predicate, const db::TableStatistics* statistics) noexcept;
+[[nodiscard]] double estimate_selectivity(const BoundWhere& where, const db::TableStatistics* statistics) noexcept;
+
+// Ожидаемое число строк, которое вернет просмотр таблицы с условием
+[[nodiscard]] double estimate_rows(const BoundWhere& where, const db::Table& table);
+
+// Единственный путь доступа - последовательный просмотр, поэтому план
+// выбирает порядок вычисления условий: в группе AND сначала условия с
+// наименьшей стоимостью на отброшенную строку, группы OR - начиная с
+// самой вероятной. Заполняет where.selectivity.
+void order_predicates(BoundWhere& where, const db::Table& table);
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "sql/AST.hpp"
+#include "sql/ResultSet.hpp"
+#include "sql/Session.hpp"
 #include "db/StorageEngine.hpp"
 
 namespace sql {
@@ -8,12 +10,18 @@ struct ExecResult {
     bool ok;
     std::string error;
     std::string result;
+    ResultSet result_set{};
+    // Версии строк, просмотренные оператором
+    uint64_t rows_scanned = 0;
+    // Успешная фиксация, ждущая сброса WAL (при defer_durability)
+    db::PendingCommit pending_commit{};
 };
 
 class Executor {
 public:
-    static ExecResult execute(const ParseResult& pr, db::StorageEngine& engine);
-    static std::string current_db;
+    // defer_durability: фиксация не ждет сброса WAL, а возвращает pending_commit
+    static ExecResult execute(const ParseResult& pr, db::StorageEngine& engine, Session& session,
+                              bool defer_durability = false);
 };
 
 }
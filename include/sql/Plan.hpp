@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "sql/AST.hpp"
+#include "sql/ScanKernels.hpp"
+#include "db/Row.hpp"
+
+namespace sql {
+
+// Константа из текста запроса или ссылка на параметр подготовленного запроса
+struct BoundValue {
+    db::Value value;
+    int param = -1;
+
+    [[nodiscard]] const db::Value& resolve(const std::vector<db::Value>& params) const {
+        return param == -1 ? value : params[static_cast<size_t>(param)];
+    }
+};
+
+struct Predicate {
+    size_t column;
+    BoundValue value;
+    CompareKernel compare = nullptr;
+};
+
+// WHERE в виде OR из групп условий, соединенных AND
+struct BoundWhere {
+    bool present = false;
+    std::vector<std::vector<Predicate>> any_of;
+    // Ожидаемая доля совпадающих строк по оценке CostModel
+    double selectivity = 1;
+};
+
+struct BoundSelect {
+    std::string table_name;
+    std::vector<size_t> columns;
+    BoundWhere where;
+};
+
+struct BoundInsert {
+    std::string table_name;
+    std::vector<size_t> target_columns;
+    std::vector<std::vector<BoundValue>> rows;
+};
+
+struct BoundUpdate {
+    std::string table_name;
+    std::vector<std::pair<size_t, BoundValue>> set;
+    BoundWhere where;
+};
+
+struct BoundDelete {
+    std::string table_name;
+    BoundWhere where;
+};
+
+bool matches(const BoundWhere& where, const db::Row& row, const std::vector<db::Value>& params);
+
+using BoundStatement = std::variant<BoundSelect, BoundInsert, BoundUpdate, BoundDelete>;
+
+struct PreparedStatement {
+    std::string query;
+    ParseResult parsed;
+    std::string db_name;
+    uint64_t schema_version = 0;
+    std::vector<ColumnType> param_types;
+    BoundStatement plan;
+};
+
+using PreparedStatements = std::unordered_map<std::string, PreparedStatement>;
+
+}
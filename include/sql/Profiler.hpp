@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sql {
+
+// Показатели одной стадии выполнения оператора для EXPLAIN ANALYZE
+struct OperatorStats {
+    std::string name;
+    std::string detail;
+    uint64_t rows_in = 0;
+    uint64_t rows_out = 0;
+    std::chrono::nanoseconds elapsed{0};
+    uint64_t bytes_allocated = 0;
+    uint64_t blocks = 0;
+    uint64_t blocks_skipped = 0;
+};
+
+// Собирает стадии оператора, выполняемого в этом потоке, пока объект жив.
+// Исполнители отмечают стадии через OperatorScope; без активного
+// профилировщика OperatorScope ничего не делает.
+class Profiler {
+public:
+    Profiler();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    [[nodiscard]] static Profiler* current() noexcept;
+    [[nodiscard]] const std::vector<OperatorStats>& get_operators() const noexcept { return operators_; }
+
+private:
+    friend class OperatorScope;
+
+    std::vector<OperatorStats> operators_;
+    Profiler* previous_;
+};
+
+class OperatorScope {
+public:
+    OperatorScope(std::string_view name, std::string_view detail = {});
+    ~OperatorScope();
+
+    OperatorScope(const OperatorScope&) = delete;
+    OperatorScope& operator=(const OperatorScope&) = delete;
+
+    // Закрывает стадию раньше конца области видимости
+    void finish() noexcept;
+
+    void add_rows_in(uint64_t rows) noexcept {
+        if (profiler_) rows_in_ += rows;
+    }
+    void add_rows_out(uint64_t rows) noexcept {
+        if (profiler_) rows_out_ += rows;
+    }
+    void add_blocks(uint64_t blocks, uint64_t skipped = 0) noexcept {
+        if (profiler_) {
+            blocks_ += blocks;
+            blocks_skipped_ += skipped;
+        }
+    }
+
+private:
+    Profiler* profiler_;
+    size_t index_ = 0;
+    std::chrono::steady_clock::time_point started_;
+    uint64_t bytes_at_start_ = 0;
+    uint64_t rows_in_ = 0;
+    uint64_t rows_out_ = 0;
+    uint64_t blocks_ = 0;
+    uint64_t blocks_skipped_ = 0;
+};
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+
+namespace sql {
+
+// Память для временных данных одного оператора. Выделения идут из
+// монотонного буфера потока без блокировок и освобождаются разом, когда
+// оператор завершается. Вне оператора current() возвращает обычную кучу.
+// Из арены берутся текст WHERE при связывании, множества значений проверки
+// внешних ключей, списки строк для действий ON DELETE / ON UPDATE, список
+// отобранных строк SELECT и списки новых строк INSERT. Значения новых версий
+// строк переходят в таблицу, а ResultSet живет дольше оператора, поэтому они
+// выделяются в куче.
+class QueryArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kInitialSize = 64 * 1024;
+
+    QueryArena();
+    ~QueryArena();
+
+    QueryArena(const QueryArena&) = delete;
+    QueryArena& operator=(const QueryArena&) = delete;
+
+    [[nodiscard]] static std::pmr::memory_resource* current() noexcept;
+    // Сколько байт выдала текущая арена (0 вне оператора)
+    [[nodiscard]] static uint64_t allocated_bytes() noexcept;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    std::optional<std::pmr::monotonic_buffer_resource> resource_;
+    QueryArena* previous_;
+    uint64_t allocated_ = 0;
+};
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "sql/AST.hpp"
+#include "sql/Session.hpp"
+#include "db/StorageEngine.hpp"
+
+namespace sql {
+
+// Оператор, результат которого можно взять из кэша: SELECT вне явной транзакции
+struct CachedQuery {
+    // База, режим ответа и нормализованный текст (для EXECUTE - с параметрами)
+    std::string key;
+    std::string database;
+    std::string table;
+};
+
+// Текст без лишних пробелов вне строковых литералов и без завершающей ';'
+[[nodiscard]] std::string normalize_statement(std::string_view query);
+
+// nullopt - оператор не кэшируется
+[[nodiscard]] std::optional<CachedQuery> cached_query(const ParseResult& pr, const Session& session,
+                                                      std::string_view query, bool binary);
+
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Готовые ответы на SELECT, ограниченные по объему, с вытеснением LRU.
+// Запись хранит снимок, по которому получен результат, и версию схемы:
+// она устаревает, как только таблицу изменит фиксация новее снимка.
+class ResultCache {
+public:
+    // Состояние до выполнения оператора, с которым сохраняется его результат
+    struct Ticket {
+        bool valid = false;
+        uint64_t schema_version = 0;
+        db::Version snapshot = 0;
+    };
+
+    // 0 - кэш выключен
+    static void set_capacity(size_t bytes);
+    [[nodiscard]] static bool enabled() noexcept;
+
+    // При промахе заполняет ticket для последующего store
+    [[nodiscard]] static std::optional<std::string> lookup(const CachedQuery& query, const db::StorageEngine& engine,
+                                                           Ticket& ticket);
+    static void store(const CachedQuery& query, const Ticket& ticket, const std::string& body);
+
+    [[nodiscard]] static ResultCacheStats stats();
+};
+
+}
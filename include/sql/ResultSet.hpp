@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "db/Row.hpp"
+
+namespace sql {
+
+enum class ResultType : uint8_t {
+    INT = 1,
+    FLOAT = 2,
+    BOOL = 3,
+    STR = 4
+};
+
+// Колонка результата в колоночном виде: значения фиксированной ширины,
+// битовая карта NULL и строки в общем буфере со смещениями.
+struct ResultColumn {
+    std::string name;
+    ResultType type = ResultType::STR;
+    std::vector<uint8_t> null_bitmap;
+    std::vector<int32_t> ints;
+    std::vector<float> floats;
+    std::vector<uint8_t> bools;
+    std::vector<uint32_t> offsets{0};
+    std::string chars;
+    size_t size = 0;
+
+    void reserve(size_t rows);
+    void append(const db::Value& value);
+    [[nodiscard]] bool is_null(size_t row) const noexcept;
+    // Дописывает текстовое представление ячейки без промежуточных строк
+    void append_cell(std::string& out, size_t row) const;
+};
+
+class ResultSet {
+public:
+    static constexpr size_t kBatchRows = 4096;
+
+    void add_column(std::string name, const std::string& type);
+    void reserve(size_t rows);
+    void append_value(size_t column, const db::Value& value) { columns_[column].append(value); }
+
+    [[nodiscard]] size_t column_count() const noexcept { return columns_.size(); }
+    [[nodiscard]] size_t row_count() const noexcept { return columns_.empty() ? 0 : columns_.front().size; }
+    [[nodiscard]] const std::vector<ResultColumn>& get_columns() const noexcept { return columns_; }
+
+    [[nodiscard]] std::string to_text() const;
+    // Заголовок и каждый пакет строк передаются emit отдельно. Пакет не больше
+    // kBatchRows строк и max_payload байт; false, если одна строка больше
+    // max_payload или emit вернул false
+    bool serialize_binary(size_t max_payload, const std::function<bool(std::string_view)>& emit) const;
+
+private:
+    std::vector<ResultColumn> columns_;
+};
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "db/Row.hpp"
+
+namespace sql {
+
+enum class ColumnType : uint8_t {
+    INT,
+    FLOAT,
+    STR,
+    BOOL,
+    UNKNOWN
+};
+
+enum class CompareOp : uint8_t {
+    EQ,
+    LT
+};
+
+// Сравнение значения ячейки с операндом. Ядро выбирается один раз при
+// связывании по типу колонки и оператору, поэтому во внутреннем цикле
+// значения сравниваются напрямую, без std::visit и сравнения имен типов.
+using CompareKernel = bool (*)(const db::Value& cell, const db::Value& operand) noexcept;
+
+[[nodiscard]] ColumnType column_type_from(const std::string& type) noexcept;
+[[nodiscard]] const char* column_type_name(ColumnType type) noexcept;
+// Значение подходит колонке типа type: NULL или альтернатива db::Value с тем
+// же номером. Тип колонки разрешается при связывании, имя типа не сравнивается
+[[nodiscard]] bool value_matches_type(const db::Value& value, ColumnType type) noexcept;
+[[nodiscard]] CompareKernel select_compare_kernel(ColumnType type, CompareOp op) noexcept;
+
+}
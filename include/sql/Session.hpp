@@ -0,0 +1,17 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "sql/Plan.hpp"
+#include "db/Transaction.hpp"
+
+namespace sql {
+
+// Состояние одного клиентского соединения
+struct Session {
+    std::string current_db;
+    PreparedStatements prepared;
+    // Открытая явная транзакция; при закрытии соединения откатывается
+    std::unique_ptr<db::Transaction> transaction;
+};
+
+}
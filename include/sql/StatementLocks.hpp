@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+#include "sql/AST.hpp"
+#include "sql/Session.hpp"
+#include "db/StorageEngine.hpp"
+#include "db/Transaction.hpp"
+
+namespace sql {
+
+[[nodiscard]] bool is_schema_change(CommandType type) noexcept;
+[[nodiscard]] bool is_write(const ParseResult& pr) noexcept;
+// Для EXECUTE - разобранный подготовленный запрос, для остальных - сам оператор
+[[nodiscard]] const ParseResult& resolve_statement(const ParseResult& pr, const Session& session);
+
+// Блокировки, которые держатся на время выполнения одного оператора.
+// CREATE/DROP берут каталог эксклюзивно, остальные команды - разделяемо
+// плюс блокировки затронутых таблиц, захватываемые в едином порядке
+// и передаваемые неявной транзакции изменяющего оператора.
+// Чтения таблиц не блокируют: они работают со снимком версий.
+// Внутри явной транзакции каталог уже удерживается с BEGIN, а таблицы
+// блокируются эксклюзивно до конца транзакции с ограничением времени ожидания.
+class StatementLocks {
+public:
+    static constexpr std::chrono::seconds kLockTimeout{5};
+
+    StatementLocks(const ParseResult& pr, const db::StorageEngine& engine, Session& session,
+                   db::Transaction* transaction);
+
+    StatementLocks(const StatementLocks&) = delete;
+    StatementLocks& operator=(const StatementLocks&) = delete;
+
+    bool is_acquired() const noexcept { return acquired_; }
+
+private:
+    std::shared_lock<db::RwLock> catalog_shared_;
+    std::unique_lock<db::RwLock> catalog_exclusive_;
+    bool acquired_ = true;
+};
+
+}
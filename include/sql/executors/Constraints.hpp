@@ -0,0 +1,121 @@
+#pragma once
+#include <deque>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "db/Database.hpp"
+#include "db/Transaction.hpp"
+#include "db/ValueUtils.hpp"
+
+namespace sql {
+namespace executors {
+
+struct ValuePtrHash {
+    size_t operator()(const db::Value* v) const noexcept { return db::value_hash(*v); }
+};
+
+struct ValuePtrEqual {
+    bool operator()(const db::Value* a, const db::Value* b) const noexcept { return db::value_equals(*a, *b); }
+};
+
+// Множество указателей на значения строк: строки не перемещаются, пока
+// оператор держит блокировки таблиц, поэтому значения не копируются,
+// а узлы множества живут в арене оператора
+using ValueSet = std::pmr::unordered_set<const db::Value*, ValuePtrHash, ValuePtrEqual>;
+
+// Проверки ограничений выполняются писателями и видят текущие версии строк
+
+// Колонка, ссылающаяся внешним ключом на проверяемую таблицу; ссылка может
+// вести и из самой таблицы (дерево строк)
+struct ReferencingColumn {
+    std::string table_name;
+    const db::Table* table;
+    size_t column;
+    const db::ForeignKey* fk;
+};
+
+ValueSet collect_column_values(const db::Table& table, int column_index);
+std::vector<ReferencingColumn> find_referencing_columns(const db::Database& db, std::string_view table_name, std::string_view column_name = {});
+bool check_foreign_keys(const db::Database& db, const db::Table& table, std::span<const db::Row> rows, std::string& error);
+// Память, которую займут новые версии строк
+size_t rows_memory(std::span<const db::Row> rows);
+// Новые версии строк не должны вывести память таблиц за глобальный предел
+bool check_memory_bytes(size_t bytes, std::string& error);
+bool check_memory_limit(std::span<const db::Row> rows, std::string& error);
+
+// Удаления и изменения строк оператора вместе с теми, которых требуют действия
+// внешних ключей (ON DELETE / ON UPDATE). Изменения обходятся волнами: ключи
+// волны собираются в хеш-множества, и каждая ссылающаяся таблица просматривается
+// один раз на внешний ключ. Строки только отбираются; apply меняет таблицы после
+// успешной проверки всех волн и значений, записанных действиями, поэтому
+// неудачный оператор ничего не оставляет.
+// Списки отобранных строк живут в арене оператора; в куче только значения
+// новых версий, которые переходят в таблицу.
+class ReferentialActions {
+public:
+    explicit ReferentialActions(db::Database& db);
+
+    // Строки изменяемой таблицы, отобранные оператором
+    void delete_row(db::Table& table, const db::Row& row);
+    void update_row(db::Table& table, const db::Row& row, db::Row new_row);
+
+    // false - сработал RESTRICT
+    [[nodiscard]] bool resolve(std::string& error);
+    [[nodiscard]] bool check_memory_limit(std::string& error) const;
+    void apply(const db::StatementVersion& version);
+
+    // Строки других таблиц, удаленные или измененные действиями
+    [[nodiscard]] size_t cascaded_rows() const noexcept { return cascaded_rows_; }
+
+private:
+    // Изменение колонки в новой версии строки, еще не распространенное по ссылкам
+    struct ColumnChange {
+        size_t version;
+        size_t column;
+        // Значение записано действием внешнего ключа, а не оператором
+        bool by_action;
+    };
+
+    struct TableChanges {
+        TableChanges(db::Table& table, std::pmr::memory_resource* memory);
+
+        std::string name;
+        db::Table* table;
+        std::pmr::vector<const db::Row*> deleted;
+        std::pmr::unordered_set<const db::Row*> deleted_set;
+        std::pmr::vector<const db::Row*> updated;
+        std::pmr::vector<db::Row> new_versions;
+        std::pmr::unordered_map<const db::Row*, size_t> version_of;
+        std::pmr::vector<ColumnChange> changes;
+        // Начало еще не обработанной части deleted и changes
+        size_t next_deleted = 0;
+        size_t next_change = 0;
+    };
+
+    TableChanges& changes_for(db::Table& table);
+    bool add_delete(TableChanges& changes, const db::Row& row);
+    // Первое изменение колонки строки побеждает, поэтому обход циклов конечен
+    bool set_value(TableChanges& changes, const db::Row& row, size_t column, const db::Value& value);
+    bool process_wave(TableChanges& parent, std::string& error);
+    const TableChanges* find_changes(const db::Table& table) const;
+    // Ключи колонки, которые останутся в таблице после оператора
+    ValueSet final_values(const db::Table& table, size_t column) const;
+    // Значения, записанные CASCADE и SET NULL, сверяются с типом колонки и всеми
+    // ее внешними ключами по состоянию после оператора; значения самого оператора -
+    // когда он меняет и таблицу, на которую они ссылаются
+    bool check_written_values(std::string& error) const;
+
+    db::Database& db_;
+    std::pmr::deque<TableChanges> tables_;
+    size_t cascaded_rows_ = 0;
+};
+
+// Дополнение к ответу оператора о строках, измененных действиями внешних ключей
+std::string cascaded_suffix(const ReferentialActions& actions);
+
+}
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "sql/AST.hpp"
+#include "sql/Executor.hpp"
+#include "db/StorageEngine.hpp"
+#include "db/Transaction.hpp"
+
+namespace sql {
+namespace executors {
+
+// Каталог сервера, в котором COPY читает и пишет файлы. Пути в COPY задаются
+// относительно него и не могут из него выйти; без каталога COPY запрещен.
+class CopyDirectory {
+public:
+    [[nodiscard]] static const std::string& get() noexcept { return path_; }
+    // Каталог должен существовать и не содержать рабочий каталог сервера с файлами БД
+    static bool set(const std::string& path, std::string& error);
+
+private:
+    static inline std::string path_;
+};
+
+ExecResult execute_copy(const Copy& cmd, db::StorageEngine& engine, const std::string& current_db, const db::StatementVersion& version);
+
+}
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "sql/AST.hpp"
+#include "sql/Executor.hpp"
+#include "sql/Session.hpp"
+#include "db/StorageEngine.hpp"
+
+namespace sql {
+namespace executors {
+
+ExecResult execute_explain(const Explain& cmd, db::StorageEngine& engine, Session& session);
+
+}
+}
@@ -1,12 +1,15 @@
 #pragma once
 #include "sql/AST.hpp"
 #include "sql/Executor.hpp"
+#include "sql/Plan.hpp"
 #include "db/StorageEngine.hpp"
+#include "db/Transaction.hpp"
 
 namespace sql {
 namespace executors {
 
-ExecResult execute_insert(const Insert& cmd, db::StorageEngine& engine, const std::string& current_db);
+ExecResult execute_insert(const Insert& cmd, db::StorageEngine& engine, const std::string& current_db, const db::StatementVersion& version);
+ExecResult run_insert(const BoundInsert& plan, db::Database& db, const std::vector<db::Value>& params, const db::StatementVersion& version);
 
 }
 }
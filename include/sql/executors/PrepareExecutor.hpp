@@ -0,0 +1,16 @@
+#pragma once
+#include "sql/AST.hpp"
+#include "sql/Executor.hpp"
+#include "sql/Plan.hpp"
+#include "db/StorageEngine.hpp"
+#include "db/Transaction.hpp"
+
+namespace sql {
+namespace executors {
+
+ExecResult execute_prepare(const Prepare& cmd, db::StorageEngine& engine, const std::string& current_db, PreparedStatements& prepared);
+ExecResult execute_execute(const Execute& cmd, db::StorageEngine& engine, const std::string& current_db, PreparedStatements& prepared, const db::StatementVersion& version);
+ExecResult execute_deallocate(const Deallocate& cmd, PreparedStatements& prepared);
+
+}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "sql/AST.hpp"
+#include "sql/Executor.hpp"
+#include "sql/Session.hpp"
+#include "db/StorageEngine.hpp"
+
+namespace sql {
+namespace executors {
+
+// Строка SHOW STATS и файла метрик: имя показателя и значение
+struct MetricLine {
+    std::string name;
+    std::string value;
+};
+
+struct TableMemoryLine {
+    std::string database;
+    std::string table;
+    db::TableMemory memory;
+};
+
+// Вызывающий удерживает каталог хотя бы разделяемо
+std::vector<TableMemoryLine> collect_table_memory(const db::StorageEngine& engine);
+// catalog_held - каталог уже удерживается вызывающим (сессия в транзакции)
+std::vector<MetricLine> collect_metrics(const db::StorageEngine& engine, bool catalog_held = false);
+ExecResult execute_show(const Show& cmd, const db::StorageEngine& engine, const Session& session);
+
+}
+}
@@ -0,0 +1,17 @@
+#pragma once
+#include <memory>
+#include "sql/AST.hpp"
+#include "sql/Executor.hpp"
+#include "db/StorageEngine.hpp"
+#include "db/Transaction.hpp"
+
+namespace sql {
+namespace executors {
+
+ExecResult execute_begin(db::StorageEngine& engine, std::unique_ptr<db::Transaction>& transaction);
+ExecResult execute_commit(db::StorageEngine& engine, std::unique_ptr<db::Transaction>& transaction,
+                          bool defer_durability = false);
+ExecResult execute_rollback(std::unique_ptr<db::Transaction>& transaction);
+
+}
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include "sql/AST.hpp"
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_analyze(std::istringstream& iss);
+
+}
+}
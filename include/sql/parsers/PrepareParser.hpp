@@ -0,0 +1,12 @@
+#pragma once
+#include "sql/AST.hpp"
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_prepare(std::istringstream& iss);
+ParseResult parse_execute(std::istringstream& iss);
+ParseResult parse_deallocate(std::istringstream& iss);
+
+}
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "sql/AST.hpp"
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_begin(std::istringstream& iss);
+ParseResult parse_commit(std::istringstream& iss);
+ParseResult parse_rollback(std::istringstream& iss);
+
+}
+}
@@ -1,13 +1,21 @@
 #pragma once
 #include <string>
+#include <string_view>
+#include <vector>
 #include "db/Row.hpp"
 
 namespace sql {
 namespace parsers {
 
 std::string to_upper(const std::string& s);
-db::Value parse_value(const std::string& val);
+// Сравнение с ключевым словом в верхнем регистре без копии слова
+bool equals_upper(std::string_view word, std::string_view upper) noexcept;
+db::Value parse_value(std::string_view val);
+// Значение записано строкой в кавычках: в подготовленном запросе это константа
+bool is_quoted(std::string_view val) noexcept;
 std::string value_to_string(const db::Value& value);
+bool parse_value_tuple(std::istream& is, std::vector<db::Value>& values, std::string& error,
+                       std::vector<bool>* quoted = nullptr);
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,59 @@
+#include "db/Checksum.hpp"
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define SQL_DB_CRC32C_SSE42 1
+#endif
+
+namespace db {
+
+namespace {
+constexpr uint32_t kPolynomial = 0x82F63B78;
+
+constexpr std::array<uint32_t, 256> make_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1)));
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kTable = make_table();
+
+uint32_t crc32c_table(const unsigned char* data, size_t size, uint32_t crc) noexcept {
+    while (size-- > 0) crc = kTable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef SQL_DB_CRC32C_SSE42
+__attribute__((target("sse4.2")))
+uint32_t crc32c_sse42(const unsigned char* data, size_t size, uint32_t crc) noexcept {
+    uint64_t crc64 = crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; size > 0; ++data, --size) crc = _mm_crc32_u8(crc, *data);
+    return crc;
+}
+
+const bool kHasSse42 = __builtin_cpu_supports("sse4.2");
+#endif
+}
+
+uint32_t crc32c(const void* data, size_t size, uint32_t crc) noexcept {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef SQL_DB_CRC32C_SSE42
+    if (kHasSse42) return ~crc32c_sse42(bytes, size, crc);
+#endif
+    return ~crc32c_table(bytes, size, crc);
+}
+
+}
@@ -12,6 +12,11 @@ void Database::drop_table(std::string_view table_name) {
     tables_.erase(std::string(table_name));
 }
 
+void Database::add_table(Table table) {
+    std::string table_name = table.get_name();
+    tables_.insert_or_assign(std::move(table_name), std::move(table));
+}
+
 const Table* Database::get_table(std::string_view table_name) const noexcept {
     auto it = tables_.find(std::string(table_name));
     return it != tables_.end() ? &it->second : nullptr;
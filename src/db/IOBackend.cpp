@@ -0,0 +1,615 @@
+#include "db/IOBackend.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define SQL_DB_HAS_IO_URING 1
+#endif
+
+namespace db {
+
+namespace {
+
+bool write_all(int fd, const char* data, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t written = offset < 0 ? ::write(fd, data, size) : ::pwrite(fd, data, size, offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        if (offset >= 0) offset += written;
+    }
+    return true;
+}
+
+// Размер частей, которыми читает pread/pwrite
+constexpr size_t kReadChunkSize = 256 * 1024;
+
+// Переносимый вариант: каждая операция выполняется сразу
+class PosixBackend : public IOBackend {
+public:
+    std::string_view name() const noexcept override { return "posix"; }
+
+    void write_file(std::string path, std::string data) override {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd == -1) {
+            ok_ = false;
+            return;
+        }
+        bool ok = write_all(fd, data.data(), data.size(), 0) && ::fsync(fd) == 0;
+        ok_ = ::close(fd) == 0 && ok && ok_;
+    }
+
+    bool wait() override {
+        bool ok = ok_;
+        ok_ = true;
+        return ok;
+    }
+
+    bool read_file(const std::string& path, const std::function<bool(std::string_view)>& consume) override {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) return false;
+        std::string buffer(kReadChunkSize, '\0');
+        bool ok = true;
+        for (;;) {
+            ssize_t got = ::read(fd, buffer.data(), buffer.size());
+            if (got < 0) {
+                if (errno == EINTR) continue;
+                ok = false;
+                break;
+            }
+            if (got == 0) break;
+            if (!consume(std::string_view(buffer.data(), static_cast<size_t>(got)))) {
+                ok = false;
+                break;
+            }
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    bool append_sync(int fd, std::string_view data) override {
+        return write_all(fd, data.data(), data.size(), -1) && ::fdatasync(fd) == 0;
+    }
+
+private:
+    bool ok_ = true;
+};
+
+#ifdef SQL_DB_HAS_IO_URING
+
+constexpr unsigned kRingEntries = 64;
+// Зарегистрированные в ядре буферы: через них идут записи и чтения файлов снимка
+constexpr size_t kBufferCount = 8;
+constexpr size_t kBufferSize = 256 * 1024;
+// Выравнивание смещений, длин и адресов для O_DIRECT
+constexpr size_t kDirectAlignment = 4096;
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// Кольца отправки и завершения, отображенные из ядра
+class Ring {
+public:
+    ~Ring() { close(); }
+
+    void close() noexcept {
+        if (sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_size_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_ != MAP_FAILED) ::munmap(sq_ptr_, sq_size_);
+        if (fd_ != -1) ::close(fd_);
+        sqes_ = cq_ptr_ = sq_ptr_ = MAP_FAILED;
+        fd_ = -1;
+        outstanding_ = 0;
+    }
+
+    bool init(unsigned entries) {
+        io_uring_params params{};
+        fd_ = io_uring_setup(entries, &params);
+        if (fd_ < 0) return false;
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+
+        sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) return false;
+        cq_ptr_ = single_mmap ? sq_ptr_
+                              : ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) return false;
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        auto* sq = static_cast<char*>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        auto* cq = static_cast<char*>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        local_tail_ = *sq_tail_;
+        return true;
+    }
+
+    int fd() const noexcept { return fd_; }
+
+    // Операции, выданные get_sqe, чьи завершения еще не разобраны
+    [[nodiscard]] size_t outstanding() const noexcept { return outstanding_; }
+
+    [[nodiscard]] unsigned free_entries() const noexcept {
+        return sq_entries_ - (local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE));
+    }
+
+    // nullptr - очередь отправки заполнена, нужен submit
+    io_uring_sqe* get_sqe() noexcept {
+        if (free_entries() == 0) return nullptr;
+        const unsigned index = local_tail_ & sq_mask_;
+        auto* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        ++local_tail_;
+        ++unsubmitted_;
+        ++outstanding_;
+        return sqe;
+    }
+
+    // Отправляет подготовленные операции одним вызовом и ждет min_complete завершений
+    bool submit(unsigned min_complete = 0) {
+        __atomic_store_n(sq_tail_, local_tail_, __ATOMIC_RELEASE);
+        while (unsubmitted_ > 0 || min_complete > 0) {
+            int ret = io_uring_enter(fd_, unsubmitted_, min_complete, min_complete > 0 ? IORING_ENTER_GETEVENTS : 0);
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            unsubmitted_ -= std::min<unsigned>(unsubmitted_, static_cast<unsigned>(ret));
+            min_complete = 0;
+        }
+        return true;
+    }
+
+    // Передает готовые завершения в handler(user_data, res)
+    template <typename Handler>
+    size_t reap(Handler&& handler) {
+        unsigned head = *cq_head_;
+        const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        size_t count = 0;
+        for (; head != tail; ++head, ++count) {
+            const auto& cqe = cqes_[head & cq_mask_];
+            handler(cqe.user_data, cqe.res);
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        outstanding_ -= std::min(outstanding_, count);
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+    void* sq_ptr_ = MAP_FAILED;
+    void* cq_ptr_ = MAP_FAILED;
+    void* sqes_ = MAP_FAILED;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned local_tail_ = 0;
+    unsigned unsubmitted_ = 0;
+    size_t outstanding_ = 0;
+};
+
+size_t align_up(size_t size) {
+    return (size + kDirectAlignment - 1) / kDirectAlignment * kDirectAlignment;
+}
+
+// Данные файлов снимка копируются в зарегистрированные буферы и пишутся из них
+// пачками: пока ядро пишет одни буферы, вызывающий сериализует следующий файл.
+class UringBackend : public IOBackend {
+public:
+    explicit UringBackend(bool direct) : direct_(direct) {}
+
+    ~UringBackend() override {
+        (void)wait();
+        // После аварийного закрытия кольца ядро может еще обращаться к буферам
+        if (broken_) return;
+        for (auto& buffer : buffers_) std::free(buffer.data);
+    }
+
+    bool init() {
+        if (!ring_.init(kRingEntries)) return false;
+        std::vector<iovec> iovecs;
+        for (size_t i = 0; i < kBufferCount; ++i) {
+            void* data = nullptr;
+            if (::posix_memalign(&data, kDirectAlignment, kBufferSize) != 0) return false;
+            buffers_.push_back({static_cast<char*>(data)});
+            iovecs.push_back({data, kBufferSize});
+        }
+        // Без регистрации (например, при низком RLIMIT_MEMLOCK) буферы работают как обычные
+        registered_ = io_uring_register(ring_.fd(), IORING_REGISTER_BUFFERS, iovecs.data(),
+                                        static_cast<unsigned>(iovecs.size())) == 0;
+        return true;
+    }
+
+    std::string_view name() const noexcept override { return "io_uring"; }
+
+    void write_file(std::string path, std::string data) override {
+        if (broken_) return fallback_.write_file(std::move(path), std::move(data));
+        const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        int fd = -1;
+        bool direct = false;
+        // Файловая система может не поддерживать O_DIRECT: тогда файл пишется обычным образом
+        if (direct_) {
+            fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+            direct = fd != -1;
+        }
+        if (fd == -1) fd = ::open(path.c_str(), flags, 0644);
+        if (fd == -1) {
+            ok_ = false;
+            return;
+        }
+        files_.push_back({fd, direct, std::move(data)});
+        pump(false);
+    }
+
+    bool wait() override {
+        flush_writes();
+
+        // fsync файлов отправляется пачками по размеру кольца; после неудачной записи
+        // результат уже известен, и файлы только закрываются
+        for (size_t begin = 0; ok_ && !broken_ && begin < files_.size(); begin += kRingEntries) {
+            const size_t end = std::min<size_t>(files_.size(), begin + kRingEntries);
+            size_t syncs = 0;
+            for (size_t i = begin; i < end; ++i) {
+                auto& file = files_[i];
+                if (file.direct && file.data.size() % kDirectAlignment != 0 &&
+                    ::ftruncate(file.fd, static_cast<off_t>(file.data.size())) != 0) {
+                    ok_ = false;
+                }
+                auto* sqe = ring_.get_sqe();
+                if (!sqe) {
+                    ok_ = ::fsync(file.fd) == 0 && ok_;
+                    continue;
+                }
+                sqe->opcode = IORING_OP_FSYNC;
+                sqe->fd = file.fd;
+                sqe->user_data = kSyncTag;
+                ++syncs;
+            }
+            while (syncs > 0) {
+                if (!ring_.submit(1)) {
+                    ok_ = false;
+                    drain([](uint64_t, int) {});
+                    break;
+                }
+                syncs -= ring_.reap([this](uint64_t, int res) {
+                    if (res < 0) ok_ = false;
+                });
+            }
+        }
+        for (auto& file : files_) {
+            if (::close(file.fd) != 0) ok_ = false;
+        }
+        files_.clear();
+        next_file_ = 0;
+        next_offset_ = 0;
+
+        bool ok = fallback_.wait() && ok_;
+        ok_ = true;
+        return ok;
+    }
+
+    bool read_file(const std::string& path, const std::function<bool(std::string_view)>& consume) override {
+        // Буферы делятся с записью: сначала дописываются поставленные файлы
+        flush_writes();
+        if (broken_) return fallback_.read_file(path, consume);
+
+        int fd = -1;
+        if (direct_) fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+        if (fd == -1) fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) return false;
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        const size_t file_size = static_cast<size_t>(st.st_size);
+
+        // Чтения всех свободных буферов отправляются одной пачкой, а прочитанные
+        // части передаются дальше по порядку: буфер занят, пока его часть не отдана
+        bool ok = true;
+        size_t next_offset = 0;
+        size_t delivered = 0;
+        size_t in_flight = 0;
+        std::vector<size_t> offsets(buffers_.size());
+        std::vector<bool> ready(buffers_.size());
+        while (ok && delivered < file_size) {
+            for (size_t i = 0; i < buffers_.size() && next_offset < file_size; ++i) {
+                if (buffers_[i].busy) continue;
+                auto* sqe = ring_.get_sqe();
+                if (!sqe) break;
+                const size_t size = std::min(kBufferSize, file_size - next_offset);
+                prepare(sqe, false, fd, i, align_up(size), next_offset);
+                buffers_[i].busy = true;
+                offsets[i] = next_offset;
+                next_offset += size;
+                ++in_flight;
+            }
+            if (!ring_.submit(1)) {
+                ok = false;
+                break;
+            }
+            ring_.reap([&](uint64_t index, int res) {
+                --in_flight;
+                const size_t size = std::min(kBufferSize, file_size - offsets[index]);
+                if (res < 0 || static_cast<size_t>(res) < size) {
+                    buffers_[index].busy = false;
+                    ok = false;
+                    return;
+                }
+                ready[index] = true;
+            });
+            // Следующая по порядку часть могла быть прочитана раньше предыдущей
+            for (bool progress = true; progress && ok;) {
+                progress = false;
+                for (size_t i = 0; i < buffers_.size(); ++i) {
+                    if (!ready[i] || offsets[i] != delivered) continue;
+                    const size_t size = std::min(kBufferSize, file_size - delivered);
+                    ok = consume(std::string_view(buffers_[i].data, size));
+                    delivered += size;
+                    ready[i] = false;
+                    buffers_[i].busy = false;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+        for (size_t i = 0; i < buffers_.size(); ++i) {
+            if (ready[i]) buffers_[i].busy = false;
+        }
+        // Ошибка: дожидаемся операций, которые еще пишут в буферы
+        drain([this](uint64_t index, int) { buffers_[index].busy = false; });
+        ::close(fd);
+        return ok;
+    }
+
+    bool append_sync(int fd, std::string_view data) override {
+        if (broken_) return fallback_.append_sync(fd, data);
+        // Запись и fdatasync связаны и уходят в ядро одним вызовом
+        if (ring_.free_entries() < 2) return write_all(fd, data.data(), data.size(), -1) && ::fdatasync(fd) == 0;
+        auto* write = ring_.get_sqe();
+        auto* sync = ring_.get_sqe();
+        write->opcode = IORING_OP_WRITE;
+        write->fd = fd;
+        write->addr = reinterpret_cast<uint64_t>(data.data());
+        write->len = static_cast<uint32_t>(data.size());
+        write->off = static_cast<uint64_t>(-1);
+        write->flags = IOSQE_IO_LINK;
+        write->user_data = kAppendTag;
+        sync->opcode = IORING_OP_FSYNC;
+        sync->fd = fd;
+        sync->fsync_flags = IORING_FSYNC_DATASYNC;
+        sync->user_data = kSyncTag;
+
+        // Запись ссылается на data вызывающего: до ее завершения возвращаться нельзя
+        int written = -1;
+        int synced = -1;
+        auto record = [&](uint64_t tag, int res) { (tag == kAppendTag ? written : synced) = res; };
+        if (!ring_.submit(2)) {
+            drain(record);
+            return false;
+        }
+        size_t done = 0;
+        while (done < 2) {
+            done += ring_.reap(record);
+            if (done < 2 && !ring_.submit(1)) {
+                drain(record);
+                return false;
+            }
+        }
+        if (written < 0) return false;
+        // Короткая запись разрывает связку: остаток дописывается обычным способом
+        if (static_cast<size_t>(written) < data.size()) {
+            data.remove_prefix(static_cast<size_t>(written));
+            return write_all(fd, data.data(), data.size(), -1) && ::fdatasync(fd) == 0;
+        }
+        return synced == 0;
+    }
+
+private:
+    struct Buffer {
+        char* data;
+        bool busy = false;
+        size_t file = 0;
+        size_t offset = 0;
+        size_t size = 0;
+        // Уже записанная часть буфера, если запись пришлось повторять
+        size_t written = 0;
+    };
+
+    struct File {
+        int fd;
+        bool direct;
+        std::string data;
+    };
+
+    // Остальные операции помечаются номером буфера
+    static constexpr uint64_t kSyncTag = ~uint64_t(0);
+    static constexpr uint64_t kAppendTag = ~uint64_t(0) - 1;
+
+    // skip - начало операции внутри буфера
+    void prepare(io_uring_sqe* sqe, bool write, int fd, size_t buffer, size_t size, size_t offset, size_t skip = 0) {
+        sqe->opcode = registered_ ? (write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED)
+                                  : (write ? IORING_OP_WRITE : IORING_OP_READ);
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buffers_[buffer].data + skip);
+        sqe->len = static_cast<uint32_t>(size);
+        sqe->off = offset;
+        sqe->buf_index = registered_ ? static_cast<uint16_t>(buffer) : 0;
+        sqe->user_data = buffer;
+    }
+
+    // Отправляет оставшиеся части поставленных файлов и дожидается их записи
+    void flush_writes() {
+        while (!broken_ && (next_file_ < files_.size() || in_flight_ > 0)) {
+            if (!pump(true)) {
+                // Отправленные записи еще идут: их завершения разбираются до закрытия файлов
+                drain([this](uint64_t index, int res) { complete(index, res); });
+                return;
+            }
+        }
+    }
+
+    // Дожидается завершения всех операций кольца и передает их в handler: пока операция
+    // не завершена, ее буфер, данные и файл трогать нельзя. Если ядро перестало
+    // принимать вызовы, кольцо закрывается, а дальше работает pread/pwrite.
+    template <typename Handler>
+    void drain(Handler&& handler) {
+        while (!broken_ && ring_.outstanding() > 0) {
+            if (!ring_.submit(1)) {
+                std::cerr << "io_uring failed: " << std::strerror(errno) << ", using pread/pwrite\n";
+                ring_.close();
+                broken_ = true;
+                ok_ = false;
+                in_flight_ = 0;
+                for (auto& buffer : buffers_) buffer.busy = false;
+                return;
+            }
+            ring_.reap(handler);
+        }
+    }
+
+    // Заполняет свободные буферы следующими частями файлов и отправляет их;
+    // block - дождаться хотя бы одного завершения
+    bool pump(bool block) {
+        size_t submitted = 0;
+        for (size_t i = 0; i < buffers_.size() && next_file_ < files_.size(); ++i) {
+            auto& buffer = buffers_[i];
+            if (buffer.busy) continue;
+            auto* sqe = ring_.get_sqe();
+            if (!sqe) break;
+
+            auto& file = files_[next_file_];
+            const size_t size = std::min(kBufferSize, file.data.size() - next_offset_);
+            std::memcpy(buffer.data, file.data.data() + next_offset_, size);
+            // Для O_DIRECT хвост дополняется нулями и после записи отрезается ftruncate
+            size_t length = size;
+            if (file.direct) {
+                length = align_up(size);
+                std::memset(buffer.data + size, 0, length - size);
+            }
+            buffer = {buffer.data, true, next_file_, next_offset_, length};
+            prepare(sqe, true, file.fd, i, length, next_offset_);
+            ++in_flight_;
+            ++submitted;
+
+            next_offset_ += size;
+            if (next_offset_ >= file.data.size()) {
+                ++next_file_;
+                next_offset_ = 0;
+            }
+        }
+        const bool wait_one = block && in_flight_ > 0;
+        if ((submitted > 0 || wait_one) && !ring_.submit(wait_one ? 1 : 0)) {
+            ok_ = false;
+            return false;
+        }
+        ring_.reap([this](uint64_t index, int res) { complete(index, res); });
+        return true;
+    }
+
+    void complete(uint64_t index, int res) {
+        auto& buffer = buffers_[index];
+        const auto& file = files_[buffer.file];
+        if (res < 0) {
+            ok_ = false;
+        } else if (buffer.written + static_cast<size_t>(res) < buffer.size) {
+            // Короткая запись: остаток ставится в очередь заново. Для O_DIRECT смещение,
+            // длина и адрес должны быть выровнены, поэтому неполный блок пишется повторно.
+            size_t done = buffer.written + static_cast<size_t>(res);
+            if (file.direct) done = done / kDirectAlignment * kDirectAlignment;
+            if (done <= buffer.written) {
+                // Запись не продвинулась ни на один (выровненный) блок
+                ok_ = false;
+            } else if (auto* sqe = ring_.get_sqe()) {
+                buffer.written = done;
+                prepare(sqe, true, file.fd, index, buffer.size - done, buffer.offset + done, done);
+                return;
+            } else if (!write_all(file.fd, buffer.data + done, buffer.size - done, static_cast<off_t>(buffer.offset + done))) {
+                // Очередь отправки заполнена: остаток с выровненного начала пишется синхронно
+                ok_ = false;
+            }
+        }
+        buffer.busy = false;
+        --in_flight_;
+    }
+
+    Ring ring_;
+    // Кольцо закрыто после ошибки: операции выполняет fallback_
+    bool broken_ = false;
+    PosixBackend fallback_;
+    bool direct_;
+    bool registered_ = false;
+    bool ok_ = true;
+    std::vector<Buffer> buffers_;
+    // Файлы, поставленные в очередь после последнего wait()
+    std::deque<File> files_;
+    size_t next_file_ = 0;
+    size_t next_offset_ = 0;
+    size_t in_flight_ = 0;
+};
+
+#endif
+
+}
+
+std::unique_ptr<IOBackend> make_io_backend(const IOOptions& options) {
+#ifdef SQL_DB_HAS_IO_URING
+    if (options.kind != IOBackendKind::POSIX) {
+        auto backend = std::make_unique<UringBackend>(options.direct);
+        if (backend->init()) return backend;
+        if (options.kind == IOBackendKind::URING) {
+            static std::atomic<bool> reported{false};
+            if (!reported.exchange(true)) std::cerr << "io_uring is not available, using pread/pwrite\n";
+        }
+    }
+#endif
+    return std::make_unique<PosixBackend>();
+}
+
+}
@@ -0,0 +1,23 @@
+#include "db/MemoryTracker.hpp"
+#include <string>
+
+namespace db {
+
+namespace {
+// Строки короче этой емкости хранятся внутри объекта std::string
+const size_t kInlineStringCapacity = std::string().capacity();
+}
+
+RowMemory row_memory(const Row& row) noexcept {
+    const auto& values = row.get_values();
+    RowMemory memory;
+    memory.values = values.capacity() * sizeof(Value);
+    for (const auto& value : values) {
+        if (const auto* s = std::get_if<std::string>(&value); s && s->capacity() > kInlineStringCapacity) {
+            memory.strings += s->capacity() + 1;
+        }
+    }
+    return memory;
+}
+
+}
@@ -2,6 +2,26 @@
 
 namespace db {
 
+Row::Row(const Row& other)
+    : values_(other.values_), begin_(other.get_begin()), end_(other.get_end()) {}
+
+Row::Row(Row&& other) noexcept
+    : values_(std::move(other.values_)), begin_(other.get_begin()), end_(other.get_end()) {}
+
+Row& Row::operator=(const Row& other) {
+    values_ = other.values_;
+    set_begin(other.get_begin());
+    set_end(other.get_end());
+    return *this;
+}
+
+Row& Row::operator=(Row&& other) noexcept {
+    values_ = std::move(other.values_);
+    set_begin(other.get_begin());
+    set_end(other.get_end());
+    return *this;
+}
+
 void to_json(json& j, const Row& r) {
     j = json::array();
     for (const auto& value : r.values_) {
@@ -0,0 +1,97 @@
+#include "db/RwLock.hpp"
+
+namespace db {
+
+namespace {
+thread_local LockWaitObserver* wait_observer = nullptr;
+
+// Сообщает наблюдателю потока об ожидании, если блокировка не свободна
+class WaitScope {
+public:
+    explicit WaitScope(bool free) : observer_(free ? nullptr : wait_observer) {
+        if (observer_) observer_->wait_started();
+    }
+    ~WaitScope() {
+        if (observer_) observer_->wait_finished();
+    }
+
+    WaitScope(const WaitScope&) = delete;
+    WaitScope& operator=(const WaitScope&) = delete;
+
+private:
+    LockWaitObserver* observer_;
+};
+}
+
+void RwLock::set_wait_observer(LockWaitObserver* observer) noexcept {
+    wait_observer = observer;
+}
+
+void RwLock::lock() {
+    std::unique_lock lock(mutex_);
+    ++waiting_writers_;
+    {
+        WaitScope scope(can_lock());
+        cv_.wait(lock, [this] { return can_lock(); });
+    }
+    --waiting_writers_;
+    writer_ = true;
+}
+
+bool RwLock::try_lock() {
+    std::lock_guard lock(mutex_);
+    if (!can_lock()) return false;
+    writer_ = true;
+    return true;
+}
+
+bool RwLock::try_lock_until(Clock::time_point deadline) {
+    std::unique_lock lock(mutex_);
+    ++waiting_writers_;
+    bool acquired;
+    {
+        WaitScope scope(can_lock());
+        acquired = cv_.wait_until(lock, deadline, [this] { return can_lock(); });
+    }
+    --waiting_writers_;
+    if (acquired) {
+        writer_ = true;
+    } else {
+        cv_.notify_all();
+    }
+    return acquired;
+}
+
+void RwLock::unlock() {
+    {
+        std::lock_guard lock(mutex_);
+        writer_ = false;
+    }
+    cv_.notify_all();
+}
+
+void RwLock::lock_shared() {
+    std::unique_lock lock(mutex_);
+    WaitScope scope(can_lock_shared());
+    cv_.wait(lock, [this] { return can_lock_shared(); });
+    ++readers_;
+}
+
+bool RwLock::try_lock_shared_until(Clock::time_point deadline) {
+    std::unique_lock lock(mutex_);
+    WaitScope scope(can_lock_shared());
+    bool acquired = cv_.wait_until(lock, deadline, [this] { return can_lock_shared(); });
+    if (acquired) ++readers_;
+    return acquired;
+}
+
+void RwLock::unlock_shared() {
+    bool last;
+    {
+        std::lock_guard lock(mutex_);
+        last = --readers_ == 0;
+    }
+    if (last) cv_.notify_all();
+}
+
+}
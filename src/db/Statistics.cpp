@@ -0,0 +1,133 @@
+#include "db/Statistics.hpp"
+#include "db/Table.hpp"
+#include "db/ValueUtils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <random>
+
+namespace db {
+
+namespace {
+constexpr size_t kHistogramBuckets = 32;
+constexpr size_t kSampleRows = 30000;
+
+// std::hash для чисел - тождественная функция, регистрам нужны равномерные биты
+uint64_t mix(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+}
+
+void HyperLogLog::add(uint64_t hash) noexcept {
+    const size_t index = hash >> (64 - kPrecisionBits);
+    const uint64_t rest = hash << kPrecisionBits;
+    const auto rank = static_cast<uint8_t>(rest == 0 ? 64 - kPrecisionBits + 1 : std::countl_zero(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+}
+
+double HyperLogLog::estimate() const noexcept {
+    constexpr double m = kRegisters;
+    const double alpha = 0.7213 / (1 + 1.079 / m);
+    double sum = 0;
+    size_t zeros = 0;
+    for (uint8_t r : registers_) {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0) ++zeros;
+    }
+    const double raw = alpha * m * m / sum;
+    // На малых количествах точнее подсчет пустых регистров
+    if (raw <= 2.5 * m && zeros > 0) return m * std::log(m / static_cast<double>(zeros));
+    return raw;
+}
+
+TableStatistics collect_statistics(const Table& table) {
+    const size_t column_count = table.get_columns().size();
+    TableStatistics stats;
+    stats.columns.resize(column_count);
+
+    std::vector<HyperLogLog> sketches(column_count);
+    std::vector<size_t> nulls(column_count, 0);
+    std::vector<const Row*> sample;
+    // Выборка воспроизводима: одинаковые данные дают одинаковую статистику
+    std::mt19937_64 random(kSampleRows);
+
+    const auto rows = table.scan();
+    for (const auto& row : rows) {
+        if (!row.is_current() || !row.is_committed()) continue;
+        const auto& values = row.get_values();
+        for (size_t i = 0; i < column_count && i < values.size(); ++i) {
+            if (std::holds_alternative<NullValue>(values[i])) {
+                ++nulls[i];
+            } else {
+                sketches[i].add(mix(value_hash(values[i])));
+            }
+        }
+
+        // Выборка резервуаром
+        if (sample.size() < kSampleRows) {
+            sample.push_back(&row);
+        } else if (size_t slot = random() % (stats.row_count + 1); slot < kSampleRows) {
+            sample[slot] = &row;
+        }
+        ++stats.row_count;
+    }
+    if (stats.row_count == 0) return stats;
+
+    std::vector<Value> values;
+    values.reserve(sample.size());
+    for (size_t i = 0; i < column_count; ++i) {
+        auto& column = stats.columns[i];
+        column.null_fraction = static_cast<double>(nulls[i]) / static_cast<double>(stats.row_count);
+        // Оценка не может превышать число непустых значений
+        column.distinct = std::min(sketches[i].estimate(), static_cast<double>(stats.row_count - nulls[i]));
+
+        values.clear();
+        for (const auto* row : sample) {
+            const auto& row_values = row->get_values();
+            if (i < row_values.size() && !std::holds_alternative<NullValue>(row_values[i])) values.push_back(row_values[i]);
+        }
+        if (values.empty()) continue;
+        std::sort(values.begin(), values.end(), [](const Value& a, const Value& b) { return value_less(a, b); });
+
+        const size_t buckets = std::min(kHistogramBuckets, values.size() - 1);
+        if (buckets == 0) {
+            column.histogram.push_back(values.front());
+            continue;
+        }
+        for (size_t b = 0; b <= buckets; ++b) {
+            column.histogram.push_back(values[b * (values.size() - 1) / buckets]);
+        }
+    }
+    return stats;
+}
+
+void to_json(json& j, const ColumnStatistics& stats) {
+    j = json::object();
+    j["null_fraction"] = stats.null_fraction;
+    j["distinct"] = stats.distinct;
+    j["histogram"] = Row(stats.histogram);
+}
+
+void from_json(const json& j, ColumnStatistics& stats) {
+    j.at("null_fraction").get_to(stats.null_fraction);
+    j.at("distinct").get_to(stats.distinct);
+    stats.histogram = j.at("histogram").get<Row>().get_values();
+}
+
+void to_json(json& j, const TableStatistics& stats) {
+    j = json::object();
+    j["row_count"] = stats.row_count;
+    j["columns"] = stats.columns;
+}
+
+void from_json(const json& j, TableStatistics& stats) {
+    j.at("row_count").get_to(stats.row_count);
+    j.at("columns").get_to(stats.columns);
+}
+
+}
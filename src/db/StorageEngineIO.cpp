@@ -1,27 +1,458 @@
 #include "db/StorageEngineIO.hpp"
-#include <fstream>
+#include "db/Statistics.hpp"
+#include "db/Checksum.hpp"
+#include "db/IOBackend.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
 #include <nlohmann/json.hpp>
+#include <stdexcept>
 #include <string_view>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 using json = nlohmann::json;
 using namespace db;
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kManifestFormat = 2;
+// Файлы снимка состоят из блоков [размер u32][crc32c u32][данные] после заголовка;
+// блок нулевого размера завершает файл, так что обрыв на границе блока тоже заметен
+constexpr std::string_view kFileMagic = "SQLDBCK1";
+constexpr size_t kBlockSize = 64 * 1024;
+constexpr size_t kBlockHeaderSize = 8;
+
+fs::path tables_dir(std::string_view path) {
+    return fs::path(std::string(path) + ".tables");
+}
+
+// Предыдущий манифест: к нему возвращается загрузка, если текущий поврежден
+std::string previous_manifest_path(std::string_view path) {
+    return std::string(path) + ".prev";
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+uint32_t get_u32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    return value;
+}
+
+std::string frame_blocks(std::string_view data) {
+    std::string out;
+    out.reserve(kFileMagic.size() + data.size() + (data.size() / kBlockSize + 2) * kBlockHeaderSize);
+    out += kFileMagic;
+    for (size_t offset = 0; offset < data.size(); offset += kBlockSize) {
+        std::string_view block = data.substr(offset, kBlockSize);
+        put_u32(out, static_cast<uint32_t>(block.size()));
+        put_u32(out, crc32c(block));
+        out += block;
+    }
+    put_u32(out, 0);
+    put_u32(out, 0);
+    return out;
+}
+
+// Проверяет блоки по мере чтения файла и собирает их данные в out
+class BlockReader {
+public:
+    BlockReader(std::string path, std::string& out, bool allow_legacy)
+        : path_(std::move(path)), out_(out), allow_legacy_(allow_legacy) {
+        out_.clear();
+    }
+
+    bool consume(std::string_view data) {
+        while (!data.empty()) {
+            switch (state_) {
+            case State::MAGIC:
+                if (!fill_header(data, kFileMagic.size())) return true;
+                if (header_ != kFileMagic) {
+                    if (!allow_legacy_) return fail("has no block header");
+                    state_ = State::LEGACY;
+                    out_ = std::move(header_);
+                    break;
+                }
+                header_.clear();
+                state_ = State::HEADER;
+                break;
+            case State::HEADER:
+                if (!fill_header(data, kBlockHeaderSize)) return true;
+                block_size_ = get_u32(header_.data());
+                block_checksum_ = get_u32(header_.data() + 4);
+                header_.clear();
+                if (block_size_ == 0) {
+                    state_ = State::DONE;
+                    break;
+                }
+                if (block_size_ > kBlockSize) return fail("has a corrupt header at block " + std::to_string(block_));
+                block_crc_ = 0;
+                state_ = State::DATA;
+                break;
+            case State::DATA: {
+                const std::string_view part = data.substr(0, block_size_);
+                block_crc_ = crc32c(part.data(), part.size(), block_crc_);
+                out_ += part;
+                data.remove_prefix(part.size());
+                block_size_ -= part.size();
+                if (block_size_ > 0) break;
+                if (block_crc_ != block_checksum_) {
+                    return fail("has a checksum mismatch at block " + std::to_string(block_));
+                }
+                ++block_;
+                state_ = State::HEADER;
+                break;
+            }
+            case State::LEGACY:
+                out_ += data;
+                return true;
+            case State::DONE:
+                return true;
+            }
+        }
+        return true;
+    }
+
+    // Файл закончился: он цел, если дочитан до завершающего блока
+    bool finish() {
+        if (state_ == State::DONE) return true;
+        if (state_ == State::LEGACY) return true;
+        if (state_ == State::MAGIC && allow_legacy_) {
+            out_ = std::move(header_);
+            return true;
+        }
+        return fail(state_ == State::MAGIC ? "has no block header" : "is truncated at block " + std::to_string(block_));
+    }
+
+    [[nodiscard]] bool framed() const noexcept { return state_ != State::LEGACY && state_ != State::MAGIC; }
+    [[nodiscard]] const std::string& error() const noexcept { return error_; }
+
+private:
+    enum class State { MAGIC, HEADER, DATA, LEGACY, DONE };
+
+    // Заголовки могут прийти разрезанными между частями чтения
+    bool fill_header(std::string_view& data, size_t size) {
+        const size_t take = std::min(size - header_.size(), data.size());
+        header_.append(data.data(), take);
+        data.remove_prefix(take);
+        return header_.size() == size;
+    }
+
+    bool fail(const std::string& what) {
+        if (error_.empty()) error_ = path_ + " " + what;
+        return false;
+    }
+
+    std::string path_;
+    std::string& out_;
+    bool allow_legacy_;
+    State state_ = State::MAGIC;
+    std::string header_;
+    uint32_t block_size_ = 0;
+    uint32_t block_checksum_ = 0;
+    uint32_t block_crc_ = 0;
+    size_t block_ = 0;
+    std::string error_;
+};
+
+// allow_legacy - файл без заголовка записан до появления блоков и берется как есть;
+// framed сообщает, был ли заголовок
+bool read_blocks(IOBackend& io, const fs::path& path, std::string& out, std::string& error,
+                 bool allow_legacy = false, bool* framed = nullptr) {
+    BlockReader reader(path.string(), out, allow_legacy);
+    const bool read = io.read_file(path.string(), [&reader](std::string_view data) { return reader.consume(data); });
+    if (!reader.error().empty()) {
+        error = reader.error();
+        return false;
+    }
+    if (!read) {
+        error = "file " + path.string() + " is missing or unreadable";
+        return false;
+    }
+    if (!reader.finish()) {
+        error = reader.error();
+        return false;
+    }
+    if (framed) *framed = reader.framed();
+    return true;
+}
+
+// Делает долговечными создание и переименование файлов в каталоге
+bool sync_directory(const fs::path& dir) {
+    int fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) return false;
+    bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+}
+
+// Манифест прежнего снимка; null, если его нет, он поврежден или в другом формате
+json read_manifest(IOBackend& io, std::string_view path) {
+    std::string data;
+    std::string error;
+    if (!read_blocks(io, std::string(path), data, error)) return nullptr;
+    json j = json::parse(data, nullptr, false);
+    if (j.is_discarded() || !j.is_object() || j.value("format", 0) != kManifestFormat) return nullptr;
+    return j;
+}
+
+// Имя файла таблицы из манифеста: только имя внутри каталога таблиц, без пути
+bool is_table_file_name(const std::string& name) {
+    return !name.empty() && name != "." && name != ".." && name.find('/') == std::string::npos &&
+           name.find('\0') == std::string::npos;
+}
+
+void add_files(const json& manifest, std::unordered_set<std::string>& files) {
+    if (manifest.is_null()) return;
+    for (const auto& [db_name, tables] : manifest.at("databases").items()) {
+        for (const auto& [table_name, file] : tables.items()) files.insert(file.get<std::string>());
+    }
+}
+
+// Файл таблицы в прежнем манифесте, если он там есть и еще не удален
+const json* previous_file(const json& manifest, const fs::path& dir, const std::string& db_name, const std::string& table_name) {
+    if (manifest.is_null()) return nullptr;
+    const auto& databases = manifest.at("databases");
+    auto db = databases.find(db_name);
+    if (db == databases.end()) return nullptr;
+    auto file = db->find(table_name);
+    if (file == db->end() || !file->is_string() || !is_table_file_name(file->get<std::string>())) return nullptr;
+    std::error_code ec;
+    return fs::exists(dir / file->get<std::string>(), ec) ? &*file : nullptr;
+}
+
+// Таблица из файла снимка; error непустой, если файл не прочитан
+struct LoadedTable {
+    std::string database;
+    std::string name;
+    fs::path file;
+    Table table;
+    std::string error;
+    std::chrono::milliseconds elapsed{0};
+};
+
+void load_table(IOBackend& io, LoadedTable& loaded) {
+    const auto started = std::chrono::steady_clock::now();
+    try {
+        std::string data;
+        if (!read_blocks(io, loaded.file, data, loaded.error)) return;
+        json::parse(data).get_to(loaded.table);
+        // Файл чужой таблицы означает испорченный манифест, а не таблицу под другим именем
+        if (loaded.table.get_name() != loaded.name) {
+            loaded.error = "file holds table " + loaded.table.get_name() + " instead of " + loaded.name;
+            return;
+        }
+        // Таблица, сохраненная без статистики, анализируется здесь же, а не первым запросом
+        if (!loaded.table.get_statistics() && AutoAnalyze::fraction() >= 0 &&
+            loaded.table.get_version_count() >= AutoAnalyze::kMinChangedRows) {
+            loaded.table.set_statistics(collect_statistics(loaded.table));
+        }
+    } catch (const std::exception& e) {
+        loaded.error = e.what();
+    }
+    loaded.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+}
+
+// Таблицы независимы: потоки разбирают их по очереди из общего списка
+void load_tables(std::vector<LoadedTable>& tables) {
+    std::atomic<size_t> next{0};
+    auto worker = [&tables, &next] {
+        auto io = make_io_backend();
+        for (size_t i = next++; i < tables.size(); i = next++) load_table(*io, tables[i]);
+    };
+    const size_t workers = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), tables.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+}
+
+}
 
 // --- save/load ---
 
-bool db::save_to_file(const StorageEngine& engine, std::string_view path) {
-    std::ofstream ofs{std::string(path)};
-    if (!ofs.is_open()) return false;
-    json j = engine;
-    ofs << j.dump(2);
+bool db::save_to_file(const StorageEngine& engine, std::string_view path, uint64_t wal_lsn) {
+    const fs::path dir = tables_dir(path);
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec) return false;
+
+    auto io = make_io_backend();
+    const json previous = read_manifest(*io, path);
+    const json backup = read_manifest(*io, previous_manifest_path(path));
+    // Новые файлы таблиц получают номер поколения и не затирают файлы обоих манифестов
+    uint64_t generation = 1;
+    for (const json* manifest : {&previous, &backup}) {
+        if (!manifest->is_null()) generation = std::max(generation, manifest->at("generation").get<uint64_t>() + 1);
+    }
+
+    // Имена баз и таблиц в имя файла не входят: связь с таблицей хранит только манифест
+    uint64_t sequence = 0;
+    json databases = json::object();
+    std::unordered_set<std::string> referenced;
+    std::vector<const Table*> written;
+    for (const auto& [db_name, database] : engine.get_databases()) {
+        json& tables = databases[db_name] = json::object();
+        for (const auto& [table_name, table] : database.get_tables()) {
+            const json* file = previous_file(previous, dir, db_name, table_name);
+            if (!table.take_dirty() && file) {
+                tables[table_name] = *file;
+                referenced.insert(file->get<std::string>());
+                continue;
+            }
+
+            // Запись файла идет, пока сериализуется следующая таблица
+            written.push_back(&table);
+            std::string name = std::to_string(generation) + "." + std::to_string(++sequence) + ".tbl";
+            io->write_file((dir / name).string(), frame_blocks(json(table).dump(2)));
+            tables[table_name] = name;
+            referenced.insert(std::move(name));
+        }
+    }
+
+    // Манифест подменяется атомарно: до rename действует прежний снимок целиком
+    bool ok = io->wait();
+    if (ok && !written.empty()) ok = sync_directory(dir);
+    if (ok) {
+        json manifest = json::object();
+        manifest["format"] = kManifestFormat;
+        manifest["generation"] = generation;
+        manifest["wal_lsn"] = wal_lsn;
+        manifest["databases"] = std::move(databases);
+        const std::string temp_path = std::string(path) + ".tmp";
+        io->write_file(temp_path, frame_blocks(manifest.dump(2)));
+        ok = io->wait();
+        // Исправный текущий манифест остается запасным; поврежденный его не заменяет
+        if (ok && !previous.is_null()) {
+            fs::rename(std::string(path), previous_manifest_path(path), ec);
+            ok = !ec;
+        }
+        if (ok) {
+            fs::rename(temp_path, std::string(path), ec);
+            ok = !ec && sync_directory(fs::path(std::string(path)).parent_path());
+        }
+    }
+    if (!ok) {
+        for (const auto* table : written) table->mark_dirty();
+        return false;
+    }
+
+    // Файлы, на которые не ссылаются ни новый, ни запасной манифест
+    add_files(previous.is_null() ? backup : previous, referenced);
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!referenced.count(entry.path().filename().string())) fs::remove(entry.path(), ec);
+    }
     return true;
 }
 
-bool db::load_from_file(StorageEngine& engine, std::string_view path) {
-    std::ifstream ifs{std::string(path)};
-    if (!ifs.is_open()) return false;
-    json j;
-    ifs >> j;
-    engine = j.get<StorageEngine>();
+namespace {
+// Меняет engine, только если снимок прочитан целиком
+bool load_snapshot(StorageEngine& engine, const std::string& path, const fs::path& dir, uint64_t& wal_lsn,
+                   std::vector<LoadedTableInfo>& infos, std::string& error) {
+    std::string data;
+    bool framed = false;
+    if (!read_blocks(*make_io_backend(), path, data, error, true, &framed)) return false;
+    json j = json::parse(data, nullptr, false);
+    if (j.is_discarded()) {
+        error = path + " is not valid JSON";
+        return false;
+    }
+    // Прежний формат: весь снимок одним документом без блоков
+    if (!j.contains("format")) {
+        try {
+            j.get_to(engine);
+        } catch (const std::exception& e) {
+            // Частично разобранный документ не должен остаться под запасным снимком
+            std::vector<std::string> names;
+            for (const auto& [name, database] : engine.get_databases()) names.push_back(name);
+            for (const auto& name : names) engine.drop_database(name);
+            error = path + " cannot be loaded: " + e.what();
+            return false;
+        }
+        wal_lsn = 0;
+        return true;
+    }
+    // Манифест всегда пишется блоками: без заголовка он поврежден
+    if (!framed) {
+        error = path + " has no block header";
+        return false;
+    }
+
+    std::vector<LoadedTable> loaded;
+    try {
+        for (const auto& [db_name, tables] : j.at("databases").items()) {
+            for (const auto& [table_name, file] : tables.items()) {
+                const std::string name = file.get<std::string>();
+                if (!is_table_file_name(name)) {
+                    error = path + " refers to table file " + name + " outside " + dir.string();
+                    return false;
+                }
+                loaded.push_back({db_name, table_name, dir / name, {}, {}, {}});
+            }
+        }
+    } catch (const std::exception& e) {
+        error = path + " cannot be loaded: " + e.what();
+        return false;
+    }
+    load_tables(loaded);
+    for (const auto& table : loaded) {
+        if (!table.error.empty()) {
+            error = "cannot load table from " + table.file.string() + ": " + table.error;
+            return false;
+        }
+    }
+
+    for (const auto& [db_name, tables] : j.at("databases").items()) engine.create_database(db_name);
+    infos.clear();
+    for (auto& table : loaded) {
+        infos.push_back({table.database, table.name, table.table.get_version_count(), table.elapsed});
+        engine.get_database(table.database)->add_table(std::move(table.table));
+    }
+    wal_lsn = j.value("wal_lsn", uint64_t{0});
     return true;
 }
+}
+
+bool db::load_from_file(StorageEngine& engine, std::string_view path, uint64_t* wal_lsn,
+                        std::vector<LoadedTableInfo>* tables) {
+    const fs::path dir = tables_dir(path);
+    const std::string previous = previous_manifest_path(path);
+    std::error_code ec;
+    const bool has_current = fs::exists(std::string(path), ec);
+    const bool has_previous = fs::exists(previous, ec);
+    if (!has_current && !has_previous) return false;
+
+    uint64_t loaded_lsn = 0;
+    if (!wal_lsn) wal_lsn = &loaded_lsn;
+    std::vector<LoadedTableInfo> loaded_tables;
+    if (!tables) tables = &loaded_tables;
+    std::string error;
+    if (has_current) {
+        if (load_snapshot(engine, std::string(path), dir, *wal_lsn, *tables, error)) return true;
+        std::cerr << "Snapshot " << path << " is damaged: " << error << "\n";
+    }
+    // Сбой между переименованиями манифестов оставляет только запасной
+    if (has_previous) {
+        if (load_snapshot(engine, previous, dir, *wal_lsn, *tables, error)) {
+            if (has_current) {
+                std::cerr << "Loaded the previous snapshot, later changes may be lost\n";
+                // Поврежденный манифест откладывается, чтобы следующее сохранение
+                // не сделало его запасным и не взяло из него файлы таблиц
+                fs::rename(std::string(path), std::string(path) + ".damaged", ec);
+            }
+            return true;
+        }
+        std::cerr << "Snapshot " << previous << " is damaged: " << error << "\n";
+    }
+    throw std::runtime_error("no valid snapshot in " + std::string(path));
+}
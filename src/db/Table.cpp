@@ -1,18 +1,43 @@
 #include "db/Table.hpp"
+#include "db/MemoryTracker.hpp"
+#include <algorithm>
+#include <iterator>
 
 namespace db {
 
+std::string_view foreign_key_action_name(ForeignKeyAction action) noexcept {
+    switch (action) {
+    case ForeignKeyAction::CASCADE: return "CASCADE";
+    case ForeignKeyAction::SET_NULL: return "SET NULL";
+    default: return "RESTRICT";
+    }
+}
+
+namespace {
+// Снимки прежних версий не содержат действий: для них действует RESTRICT
+ForeignKeyAction action_from_json(const json& j, const char* key) {
+    const std::string name = j.value(key, std::string("RESTRICT"));
+    if (name == "CASCADE") return ForeignKeyAction::CASCADE;
+    if (name == "SET NULL") return ForeignKeyAction::SET_NULL;
+    return ForeignKeyAction::RESTRICT;
+}
+}
+
 void to_json(json& j, const ForeignKey& fk) {
     j = json::object();
     j["column_name"] = fk.column_name;
     j["referenced_table"] = fk.referenced_table;
     j["referenced_column"] = fk.referenced_column;
+    j["on_delete"] = foreign_key_action_name(fk.on_delete);
+    j["on_update"] = foreign_key_action_name(fk.on_update);
 }
 
 void from_json(const json& j, ForeignKey& fk) {
     j.at("column_name").get_to(fk.column_name);
     j.at("referenced_table").get_to(fk.referenced_table);
     j.at("referenced_column").get_to(fk.referenced_column);
+    fk.on_delete = action_from_json(j, "on_delete");
+    fk.on_update = action_from_json(j, "on_update");
 }
 
 void to_json(json& j, const Column& c) {
@@ -46,21 +71,252 @@ Table::Table(std::string name, const std::vector<std::string>& column_names, con
     }
 }
 
+RowRange::RowRange(std::shared_ptr<const ChunkList> chunks) : chunks_(std::move(chunks)) {
+    if (chunks_->empty()) return;
+    // Последний сегмент может дописываться: его размер фиксируется сейчас
+    last_size_ = chunks_->back()->size.load(std::memory_order_acquire);
+    for (size_t i = 0; i < chunks_->size(); ++i) size_ += chunk_size(i);
+}
+
+size_t RowRange::chunk_size(size_t chunk) const noexcept {
+    return chunk + 1 == chunks_->size() ? last_size_ : (*chunks_)[chunk]->capacity;
+}
+
+namespace {
+constexpr size_t kMinChunkCapacity = 16;
+constexpr size_t kMaxChunkCapacity = 4096;
+
+// Добавляет строку в список сегментов, которым владеет только писатель.
+// Возвращает true, если пришлось создать новый сегмент.
+bool append_row(ChunkList& chunks, Row&& row) {
+    if (!chunks.empty()) {
+        auto& last = *chunks.back();
+        size_t size = last.size.load(std::memory_order_relaxed);
+        if (size < last.capacity) {
+            last.rows[size] = std::move(row);
+            last.size.store(size + 1, std::memory_order_release);
+            return false;
+        }
+    }
+
+    size_t capacity = chunks.empty() ? kMinChunkCapacity : std::min(chunks.back()->capacity * 2, kMaxChunkCapacity);
+    auto chunk = std::make_shared<RowChunk>(capacity);
+    chunk->rows[0] = std::move(row);
+    chunk->size.store(1, std::memory_order_relaxed);
+    chunks.push_back(std::move(chunk));
+    return true;
+}
+
+size_t chunk_memory(const RowChunk& chunk) noexcept {
+    return sizeof(RowChunk) + chunk.capacity * sizeof(Row);
+}
+
+// Закрытая версия освобождает ячейку и память значений после сборки мусора
+size_t dead_memory(const Row& row) noexcept {
+    return sizeof(Row) + row_memory(row).total();
+}
+}
+
+Table::MemoryCounters::~MemoryCounters() {
+    MemoryTracker::release(rows.load(std::memory_order_relaxed) + strings.load(std::memory_order_relaxed));
+}
+
+void Table::MemoryCounters::add(size_t row_bytes, size_t string_bytes) noexcept {
+    rows.fetch_add(row_bytes, std::memory_order_relaxed);
+    strings.fetch_add(string_bytes, std::memory_order_relaxed);
+    MemoryTracker::add(row_bytes + string_bytes);
+}
+
+void Table::MemoryCounters::reset(const TableMemory& memory) noexcept {
+    const size_t previous = rows.exchange(memory.rows, std::memory_order_relaxed) +
+                            strings.exchange(memory.strings, std::memory_order_relaxed);
+    dead.store(memory.dead, std::memory_order_relaxed);
+    MemoryTracker::add(memory.total());
+    MemoryTracker::release(previous);
+}
+
+TableMemory Table::get_memory() const noexcept {
+    return {memory_->rows.load(std::memory_order_relaxed), memory_->strings.load(std::memory_order_relaxed),
+            memory_->dead.load(std::memory_order_relaxed)};
+}
+
+RowRange Table::scan() const {
+    std::lock_guard lock(*chunks_mutex_);
+    return RowRange(chunks_);
+}
+
 void Table::insert(const Row& row) {
-    rows_.push_back(row);
+    insert(Row(row));
+}
+
+void Table::insert(Row&& row) {
+    Version version = row.get_begin();
+    std::vector<Row> rows;
+    rows.push_back(std::move(row));
+    insert_rows(rows, version);
+}
+
+void Table::insert_rows(std::span<Row> rows, Version version, std::vector<const Row*>* placed) {
+    if (rows.empty()) return;
+
+    // Новые сегменты публикуются одной заменой списка
+    ChunkList chunks = *chunks_;
+    const size_t old_chunk_count = chunks.size();
+    bool grown = false;
+    RowMemory added;
+    for (auto& row : rows) {
+        const auto memory = row_memory(row);
+        added.values += memory.values;
+        added.strings += memory.strings;
+        row.set_begin(version);
+        row.set_end(kMaxVersion);
+        grown = append_row(chunks, std::move(row)) || grown;
+        if (placed) {
+            const auto& last = *chunks.back();
+            placed->push_back(&last.rows[last.size.load(std::memory_order_relaxed) - 1]);
+        }
+    }
+    versions_->total.fetch_add(rows.size(), std::memory_order_relaxed);
+    changes_->changed_rows.fetch_add(rows.size(), std::memory_order_relaxed);
+    mark_dirty();
+    for (size_t i = old_chunk_count; i < chunks.size(); ++i) added.values += chunk_memory(*chunks[i]);
+    memory_->add(added.values, added.strings);
+
+    if (grown) {
+        auto published = std::make_shared<const ChunkList>(std::move(chunks));
+        std::lock_guard lock(*chunks_mutex_);
+        chunks_ = std::move(published);
+    }
+}
+
+void Table::retire(const Row& row, Version version) {
+    row.set_end(version);
+    versions_->dead.fetch_add(1, std::memory_order_relaxed);
+    changes_->changed_rows.fetch_add(1, std::memory_order_relaxed);
+    mark_dirty();
+    memory_->dead.fetch_add(dead_memory(row), std::memory_order_relaxed);
+}
+
+void Table::restore(const Row& row) {
+    row.set_end(kMaxVersion);
+    versions_->dead.fetch_sub(1, std::memory_order_relaxed);
+    memory_->dead.fetch_sub(dead_memory(row), std::memory_order_relaxed);
+}
+
+void Table::discard(const Row& row) {
+    row.set_end(0);
+    versions_->dead.fetch_add(1, std::memory_order_relaxed);
+    memory_->dead.fetch_add(dead_memory(row), std::memory_order_relaxed);
+}
+
+bool Table::needs_garbage_collection() const noexcept {
+    constexpr size_t kMinDeadVersions = 1024;
+    const size_t dead = get_dead_version_count();
+    return dead >= kMinDeadVersions && dead * 2 >= get_version_count();
+}
+
+size_t Table::collect_garbage(Version horizon) {
+    // Читатели старых сегментов продолжают работать с ними, пока держат RowRange
+    ChunkList chunks;
+    size_t kept = 0;
+    size_t dead = 0;
+    TableMemory memory;
+    for (const auto& row : scan()) {
+        if (row.get_end() <= horizon) continue;
+        Row copy(row);
+        const auto row_bytes = row_memory(copy);
+        memory.rows += row_bytes.values;
+        memory.strings += row_bytes.strings;
+        if (!row.is_current()) {
+            ++dead;
+            memory.dead += sizeof(Row) + row_bytes.total();
+        }
+        append_row(chunks, std::move(copy));
+        ++kept;
+    }
+    for (const auto& chunk : chunks) memory.rows += chunk_memory(*chunk);
+
+    size_t removed = get_version_count() - kept;
+    versions_->total.store(kept, std::memory_order_relaxed);
+    versions_->dead.store(dead, std::memory_order_relaxed);
+    memory_->reset(memory);
+
+    auto published = std::make_shared<const ChunkList>(std::move(chunks));
+    std::lock_guard lock(*chunks_mutex_);
+    chunks_ = std::move(published);
+    return removed;
+}
+
+std::shared_ptr<const TableStatistics> Table::get_statistics() const {
+    std::lock_guard lock(*chunks_mutex_);
+    return statistics_;
+}
+
+void Table::set_statistics(TableStatistics statistics) {
+    changes_->analyzed_rows.store(statistics.row_count, std::memory_order_relaxed);
+    changes_->changed_rows.store(0, std::memory_order_relaxed);
+    mark_dirty();
+    auto published = std::make_shared<const TableStatistics>(std::move(statistics));
+    std::lock_guard lock(*chunks_mutex_);
+    statistics_ = std::move(published);
+}
+
+bool Table::needs_analyze() const noexcept {
+    const double fraction = AutoAnalyze::fraction();
+    if (fraction < 0) return false;
+    const double threshold = AutoAnalyze::kMinChangedRows +
+                             fraction * static_cast<double>(changes_->analyzed_rows.load(std::memory_order_relaxed));
+    return static_cast<double>(changes_->changed_rows.load(std::memory_order_relaxed)) >= threshold;
+}
+
+Version Table::get_last_commit() const noexcept {
+    return changes_->last_commit.load(std::memory_order_acquire);
+}
+
+void Table::mark_committed(Version version) noexcept {
+    changes_->last_commit.store(version, std::memory_order_release);
+    mark_dirty();
+}
+
+bool Table::take_dirty() const noexcept {
+    return changes_->dirty.exchange(false, std::memory_order_acq_rel);
+}
+
+void Table::mark_dirty() const noexcept {
+    changes_->dirty.store(true, std::memory_order_release);
+}
+
+int Table::find_column(std::string_view column_name) const noexcept {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (columns_[i].get_name() == column_name) return static_cast<int>(i);
+    }
+    return -1;
 }
 
 void to_json(json& j, const Table& t) {
     j = json::object();
     j["name"] = t.name_;
     j["columns"] = t.columns_;
-    j["rows"] = t.rows_;
+    json rows = json::array();
+    for (const auto& row : t.scan()) {
+        if (row.is_current() && row.is_committed()) rows.push_back(row);
+    }
+    j["rows"] = std::move(rows);
+    if (auto statistics = t.get_statistics()) j["statistics"] = *statistics;
 }
 
 void from_json(const json& j, Table& t) {
     j.at("name").get_to(t.name_);
     j.at("columns").get_to(t.columns_);
-    j.at("rows").get_to(t.rows_);
+    t.chunks_ = std::make_shared<ChunkList>();
+    t.versions_ = std::make_unique<Table::VersionCounters>();
+    t.memory_ = std::make_unique<Table::MemoryCounters>();
+    auto rows = j.at("rows").get<std::vector<Row>>();
+    t.insert_rows(rows);
+    t.statistics_.reset();
+    t.changes_ = std::make_unique<Table::ChangeCounters>();
+    if (j.contains("statistics")) t.set_statistics(j.at("statistics").get<TableStatistics>());
+    t.changes_->dirty.store(false, std::memory_order_relaxed);
 }
 
 }
@@ -0,0 +1,175 @@
+#include "db/Transaction.hpp"
+#include "db/WriteAheadLog.hpp"
+
+namespace db {
+
+Transaction::Transaction(VersionManager& versions)
+    : versions_(versions), stamp_(versions.begin_transaction()) {}
+
+Transaction::~Transaction() {
+    if (!finished_) rollback();
+}
+
+void Transaction::hold_catalog(RwLock& catalog) {
+    catalog_ = std::shared_lock(catalog);
+}
+
+bool Transaction::lock_tables(const std::vector<TableLockRequest>& locks, RwLock::Clock::time_point deadline) {
+    for (const auto& request : locks) {
+        if (held_.count(request.lock)) continue;
+        if (request.exclusive) {
+            std::unique_lock guard(*request.lock, deadline);
+            if (!guard.owns_lock()) return false;
+            exclusive_locks_.push_back(std::move(guard));
+        } else {
+            std::shared_lock guard(*request.lock, deadline);
+            if (!guard.owns_lock()) return false;
+            shared_locks_.push_back(std::move(guard));
+        }
+        held_.insert(request.lock);
+    }
+    return true;
+}
+
+void Transaction::insert_rows(const std::string& database, Table& table, std::span<Row> rows) {
+    std::vector<const Row*> placed;
+    placed.reserve(rows.size());
+    table.insert_rows(rows, stamp_, &placed);
+
+    databases_.try_emplace(&table, database);
+    undo_.reserve(undo_.size() + placed.size());
+    for (const auto* row : placed) undo_.push_back({&table, row, true});
+}
+
+void Transaction::retire(const std::string& database, Table& table, const Row& row) {
+    table.retire(row, stamp_);
+    databases_.try_emplace(&table, database);
+    undo_.push_back({&table, &row, false});
+}
+
+bool Transaction::reclaim(Table& table) {
+    if (databases_.count(&table) || table.get_dead_version_count() == 0) return false;
+    table.collect_garbage(versions_.get_horizon());
+    return true;
+}
+
+void Transaction::rollback_to(size_t savepoint) {
+    while (undo_.size() > savepoint) {
+        const auto& entry = undo_.back();
+        if (entry.inserted) {
+            entry.table->discard(*entry.row);
+        } else {
+            entry.table->restore(*entry.row);
+        }
+        undo_.pop_back();
+    }
+}
+
+void Transaction::rollback() {
+    rollback_to(0);
+    release();
+}
+
+json Transaction::make_redo_record(Version version) const {
+    json changes = json::array();
+    const UndoEntry* group = nullptr;
+    for (const auto& entry : undo_) {
+        // Подряд идущие изменения одной таблицы одного вида идут одной группой
+        if (!group || group->table != entry.table || group->inserted != entry.inserted) {
+            json change = json::object();
+            change["database"] = databases_.at(entry.table);
+            change["table"] = entry.table->get_name();
+            change[entry.inserted ? "insert" : "delete"] = json::array();
+            changes.push_back(std::move(change));
+            group = &entry;
+        }
+        changes.back()[entry.inserted ? "insert" : "delete"].push_back(*entry.row);
+    }
+
+    json record = json::object();
+    record["version"] = version;
+    record["changes"] = std::move(changes);
+    return record;
+}
+
+bool Transaction::commit(WriteAheadLog* wal, std::string& error, PendingCommit* pending) {
+    if (undo_.empty()) {
+        release();
+        return true;
+    }
+
+    // Пока версия фиксации не завершена, снимки не видят изменений транзакции
+    auto version = std::make_shared<WriteVersion>(versions_);
+    uint64_t sequence = 0;
+    if (wal && (sequence = wal->enqueue(make_redo_record(version->get()))) == 0) {
+        error = "Failed to write the commit record";
+        rollback();
+        return false;
+    }
+
+    for (const auto& entry : undo_) {
+        if (entry.inserted) {
+            entry.row->set_begin(version->get());
+        } else {
+            entry.row->set_end(version->get());
+        }
+    }
+    std::vector<Table*> changed;
+    changed.reserve(databases_.size());
+    for (const auto& [table, database] : databases_) {
+        table->mark_committed(version->get());
+        changed.push_back(table);
+    }
+
+    undo_.clear();
+    // Блокировки снимаются до ожидания fsync, чтобы следующие транзакции успели
+    // в ту же группу. Их записи идут в журнале после этой, поэтому их
+    // подтверждение подразумевает, что и эта запись уже на диске.
+    finished_ = true;
+    release_tables();
+
+    bool durable = true;
+    if (pending && sequence != 0) {
+        *pending = {sequence, std::move(version)};
+    } else if (wal) {
+        durable = wal->wait_durable(sequence);
+    }
+    version.reset();
+
+    maintain(changed);
+    if (catalog_.owns_lock()) catalog_.unlock();
+
+    // Откатить уже видимые изменения нельзя: журнал после сбоя записи больше
+    // не принимает фиксаций, а клиенту сообщается, что исход неизвестен
+    if (!durable) {
+        error = kUnknownCommitOutcome;
+        return false;
+    }
+    return true;
+}
+
+void Transaction::maintain(const std::vector<Table*>& tables) {
+    const Version horizon = versions_.get_horizon();
+    for (auto* table : tables) {
+        // Занятую таблицу почистит следующая фиксация
+        if (table->needs_garbage_collection()) {
+            std::unique_lock lock(table->get_lock(), std::try_to_lock);
+            if (lock.owns_lock()) table->collect_garbage(horizon);
+        }
+        if (table->needs_analyze()) table->set_statistics(collect_statistics(*table));
+    }
+}
+
+void Transaction::release_tables() {
+    exclusive_locks_.clear();
+    shared_locks_.clear();
+    held_.clear();
+}
+
+void Transaction::release() {
+    finished_ = true;
+    release_tables();
+    if (catalog_.owns_lock()) catalog_.unlock();
+}
+
+}
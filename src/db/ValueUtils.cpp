@@ -1,4 +1,5 @@
 #include "db/ValueUtils.hpp"
+#include <functional>
 
 namespace db {
 
@@ -53,4 +54,15 @@ bool value_less(const Value& a, const Value& b) noexcept {
     }, a, b);
 }
 
-}
\ No newline at end of file
+size_t value_hash(const Value& v) noexcept {
+    return std::visit([&v](const auto& val) -> size_t {
+        using T = std::decay_t<decltype(val)>;
+        size_t h = 0;
+        if constexpr (!std::is_same_v<T, NullValue>) {
+            h = std::hash<T>{}(val);
+        }
+        return h ^ (v.index() * 0x9e3779b97f4a7c15ULL);
+    }, v);
+}
+
+}
@@ -0,0 +1,46 @@
+#include "db/VersionManager.hpp"
+#include <algorithm>
+
+namespace db {
+
+Version VersionManager::current_snapshot() const {
+    return in_flight_.empty() ? clock_ : *in_flight_.begin() - 1;
+}
+
+Version VersionManager::begin_transaction() noexcept {
+    return kProvisionalVersion | next_transaction_.fetch_add(1, std::memory_order_relaxed);
+}
+
+Version VersionManager::begin_write() {
+    std::lock_guard lock(mutex_);
+    Version version = ++clock_;
+    in_flight_.insert(version);
+    return version;
+}
+
+void VersionManager::end_write(Version version) {
+    std::lock_guard lock(mutex_);
+    in_flight_.erase(version);
+}
+
+Version VersionManager::acquire_snapshot() {
+    std::lock_guard lock(mutex_);
+    Version snapshot = current_snapshot();
+    snapshots_.insert(snapshot);
+    return snapshot;
+}
+
+void VersionManager::release_snapshot(Version snapshot) {
+    std::lock_guard lock(mutex_);
+    auto it = snapshots_.find(snapshot);
+    if (it != snapshots_.end()) snapshots_.erase(it);
+}
+
+Version VersionManager::get_horizon() const {
+    std::lock_guard lock(mutex_);
+    Version horizon = current_snapshot();
+    if (!snapshots_.empty()) horizon = std::min(horizon, *snapshots_.begin());
+    return horizon;
+}
+
+}
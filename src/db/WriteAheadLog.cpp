@@ -0,0 +1,394 @@
+#include "db/WriteAheadLog.hpp"
+#include "db/StorageEngineIO.hpp"
+#include "db/ValueUtils.hpp"
+#include "db/Checksum.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace db {
+
+namespace {
+size_t row_hash(const std::vector<Value>& values) noexcept {
+    size_t hash = values.size();
+    for (const auto& value : values) {
+        hash ^= value_hash(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+bool rows_equal(const std::vector<Value>& a, const std::vector<Value>& b) noexcept {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!value_equals(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+constexpr size_t kChecksumDigits = 8;
+
+// Строка журнала: CRC32C текста записи в шестнадцатеричном виде, пробел и JSON.
+// Номер записи дописывается в начало уже сериализованного объекта.
+std::string encode_record(uint64_t lsn, std::string_view record) {
+    std::string text = "{\"lsn\":" + std::to_string(lsn);
+    if (record.size() > 2) text += ',';
+    text.append(record.substr(1));
+    char checksum[kChecksumDigits + 2];
+    std::snprintf(checksum, sizeof(checksum), "%08x ", crc32c(text));
+    std::string line;
+    line.reserve(kChecksumDigits + 1 + text.size() + 1);
+    line.append(checksum, kChecksumDigits + 1);
+    line += text;
+    line += '\n';
+    return line;
+}
+
+// false - запись оборвана или повреждена. Строки без суммы записаны прежней версией.
+bool decode_record(std::string_view line, json& record) {
+    if (!line.empty() && line.front() != '{') {
+        if (line.size() <= kChecksumDigits || line[kChecksumDigits] != ' ') return false;
+        uint32_t checksum = 0;
+        for (size_t i = 0; i < kChecksumDigits; ++i) {
+            const char c = line[i];
+            uint32_t digit = 0;
+            if (c >= '0' && c <= '9') {
+                digit = static_cast<uint32_t>(c - '0');
+            } else if (c >= 'a' && c <= 'f') {
+                digit = static_cast<uint32_t>(c - 'a' + 10);
+            } else {
+                return false;
+            }
+            checksum = checksum << 4 | digit;
+        }
+        line.remove_prefix(kChecksumDigits + 1);
+        if (crc32c(line) != checksum) return false;
+    }
+    record = json::parse(line, nullptr, false);
+    return !record.is_discarded();
+}
+
+// Изменения одной таблицы из записи журнала: запись сначала целиком сопоставляется
+// с таблицами и только затем применяется, чтобы не оставить половину транзакции
+struct RedoTable {
+    Table* table = nullptr;
+    // Текущие строки по хешу значений; строится при первом удалении
+    std::unordered_multimap<size_t, const Row*> current{};
+    bool indexed = false;
+    std::vector<const Row*> retired{};
+    std::vector<Row> inserted{};
+    // Вставка, которую удалила та же запись
+    std::vector<bool> cancelled{};
+    std::unordered_multimap<size_t, size_t> inserted_index{};
+};
+
+RedoTable& redo_table(std::vector<RedoTable>& plan, Table& table) {
+    for (auto& redo : plan) {
+        if (redo.table == &table) return redo;
+    }
+    plan.push_back({&table});
+    return plan.back();
+}
+
+// Строки в журнале не имеют идентификаторов: удаляется любая текущая строка с теми же значениями
+bool plan_delete(RedoTable& redo, const Row& deleted) {
+    const size_t hash = row_hash(deleted.get_values());
+    auto [first_inserted, last_inserted] = redo.inserted_index.equal_range(hash);
+    for (auto it = first_inserted; it != last_inserted; ++it) {
+        if (rows_equal(redo.inserted[it->second].get_values(), deleted.get_values())) {
+            redo.cancelled[it->second] = true;
+            redo.inserted_index.erase(it);
+            return true;
+        }
+    }
+
+    if (!redo.indexed) {
+        for (const auto& row : redo.table->scan()) {
+            if (row.is_current()) redo.current.emplace(row_hash(row.get_values()), &row);
+        }
+        redo.indexed = true;
+    }
+    auto [first, last] = redo.current.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (rows_equal(it->second->get_values(), deleted.get_values())) {
+            redo.retired.push_back(it->second);
+            redo.current.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool plan_record(StorageEngine& engine, const json& record, std::vector<RedoTable>& plan) {
+    try {
+        for (const auto& change : record.at("changes")) {
+            auto* db = engine.get_database(change.at("database").get<std::string>());
+            auto* table = db ? db->get_table(change.at("table").get<std::string>()) : nullptr;
+            if (!table) return false;
+
+            auto& redo = redo_table(plan, *table);
+            if (change.contains("insert")) {
+                for (auto& row : change.at("insert").get<std::vector<Row>>()) {
+                    redo.inserted_index.emplace(row_hash(row.get_values()), redo.inserted.size());
+                    redo.inserted.push_back(std::move(row));
+                    redo.cancelled.push_back(false);
+                }
+                continue;
+            }
+            for (const auto& item : change.at("delete")) {
+                if (!plan_delete(redo, item.get<Row>())) return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+void apply_plan(std::vector<RedoTable>& plan) {
+    for (auto& redo : plan) {
+        for (const auto* row : redo.retired) redo.table->retire(*row, 0);
+        std::vector<Row> rows;
+        rows.reserve(redo.inserted.size());
+        for (size_t i = 0; i < redo.inserted.size(); ++i) {
+            if (!redo.cancelled[i]) rows.push_back(std::move(redo.inserted[i]));
+        }
+        if (!rows.empty()) redo.table->insert_rows(rows);
+    }
+}
+}
+
+WriteAheadLog::WriteAheadLog(std::string snapshot_path, std::string log_path, WalOptions options)
+    : snapshot_path_(std::move(snapshot_path)), log_path_(std::move(log_path)), options_(options) {
+    options_.batch_size = std::max<size_t>(options_.batch_size, 1);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    close();
+}
+
+bool WriteAheadLog::open() {
+    std::lock_guard lock(mutex_);
+    if (fd_ != -1) return true;
+    fd_ = ::open(log_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ == -1) return false;
+    io_ = make_io_backend();
+    stopping_ = false;
+    flusher_ = std::thread(&WriteAheadLog::flush_loop, this);
+    return true;
+}
+
+void WriteAheadLog::close() {
+    {
+        std::lock_guard lock(mutex_);
+        if (fd_ == -1) return;
+        stopping_ = true;
+    }
+    // Поток сброса завершается, записав все, что осталось в очереди
+    queued_.notify_all();
+    flusher_.join();
+
+    std::lock_guard lock(mutex_);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+uint64_t WriteAheadLog::enqueue(const json& record) {
+    // Сериализация идет вне блокировки; под ней только присваивается номер
+    const std::string text = record.dump();
+
+    std::lock_guard lock(mutex_);
+    if (fd_ == -1 || failed_ || stopping_) return 0;
+    pending_.push_back(encode_record(appended_ + 1, text));
+    if (pending_.size() == 1 || pending_.size() >= options_.batch_size) queued_.notify_one();
+    return ++appended_;
+}
+
+bool WriteAheadLog::wait_durable(uint64_t sequence) {
+    if (sequence == 0) return false;
+    std::unique_lock lock(mutex_);
+    if (options_.relaxed) return !failed_;
+    return wait_flushed(lock, sequence);
+}
+
+void WriteAheadLog::on_durable(uint64_t sequence, std::function<void(bool)> callback) {
+    bool durable;
+    {
+        std::lock_guard lock(mutex_);
+        if (sequence != 0 && !options_.relaxed && flushed_sequence_ < sequence && !failed_) {
+            waiters_.emplace_back(sequence, std::move(callback));
+            return;
+        }
+        durable = sequence != 0 && (options_.relaxed ? !failed_ : flushed_sequence_ >= sequence);
+    }
+    callback(durable);
+}
+
+bool WriteAheadLog::wait_flushed(std::unique_lock<std::mutex>& lock, uint64_t sequence) {
+    flushed_.wait(lock, [&] { return flushed_sequence_ >= sequence || failed_; });
+    return flushed_sequence_ >= sequence;
+}
+
+void WriteAheadLog::flush_loop() {
+    std::unique_lock lock(mutex_);
+    std::string buffer;
+    for (;;) {
+        queued_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) break;
+
+        // Неполная группа ждет попутчиков не дольше max_delay
+        if (options_.max_delay.count() > 0 && pending_.size() < options_.batch_size && !stopping_) {
+            queued_.wait_for(lock, options_.max_delay, [&] { return stopping_ || pending_.size() >= options_.batch_size; });
+        }
+
+        std::vector<std::string> batch;
+        batch.swap(pending_);
+        uint64_t last = appended_;
+        lock.unlock();
+
+        buffer.clear();
+        for (const auto& line : batch) buffer += line;
+        bool ok = io_->append_sync(fd_, buffer);
+
+        lock.lock();
+        if (ok) {
+            flushed_sequence_ = last;
+        } else {
+            std::cerr << "WAL write failed, further commits are rejected\n";
+            failed_ = true;
+        }
+        flushed_.notify_all();
+        complete_waiters(lock);
+    }
+}
+
+void WriteAheadLog::complete_waiters(std::unique_lock<std::mutex>& lock) {
+    auto ready = std::partition(waiters_.begin(), waiters_.end(), [&](const auto& waiter) {
+        return waiter.first > flushed_sequence_ && !failed_;
+    });
+    if (ready == waiters_.end()) return;
+    std::vector<std::pair<uint64_t, std::function<void(bool)>>> completed(
+        std::make_move_iterator(ready), std::make_move_iterator(waiters_.end()));
+    waiters_.erase(ready, waiters_.end());
+    const uint64_t flushed = flushed_sequence_;
+
+    // Обработчики могут снова обратиться к журналу
+    lock.unlock();
+    for (auto& [sequence, callback] : completed) callback(sequence <= flushed);
+    lock.lock();
+}
+
+bool WriteAheadLog::checkpoint(const StorageEngine& engine) {
+    uint64_t lsn = 0;
+    {
+        // Иначе записи из очереди попали бы в очищенный журнал и применились повторно
+        std::unique_lock lock(mutex_);
+        if (fd_ != -1 && !wait_flushed(lock, appended_)) return false;
+        lsn = appended_;
+    }
+
+    // Манифест снимка подменяется атомарно: при сбое остается предыдущий снимок и полный журнал.
+    // Сбой после подмены, но до очистки журнала безопасен: записи до lsn уже в снимке.
+    // Без снимка изменения схемы есть только в памяти, и следующие записи журнала
+    // могли бы ссылаться на таблицы, которых при восстановлении не окажется
+    if (!save_to_file(engine, snapshot_path_, lsn)) {
+        std::lock_guard lock(mutex_);
+        if (fd_ != -1) {
+            std::cerr << "Checkpoint failed, further commits are rejected\n";
+            failed_ = true;
+        }
+        return false;
+    }
+
+    // Неочищенный журнал безопасен: его записи до lsn при восстановлении пропускаются
+    std::lock_guard lock(mutex_);
+    if (fd_ != -1 && (::ftruncate(fd_, 0) != 0 || ::fsync(fd_) != 0)) {
+        std::cerr << "Cannot truncate WAL after checkpoint\n";
+    }
+    return true;
+}
+
+size_t WriteAheadLog::recover(StorageEngine& engine, uint64_t snapshot_lsn) {
+    {
+        std::lock_guard lock(mutex_);
+        appended_ = flushed_sequence_ = snapshot_lsn;
+    }
+    std::ifstream ifs(log_path_);
+    if (!ifs.is_open()) return 0;
+
+    size_t applied = 0;
+    uint64_t last_lsn = snapshot_lsn;
+    // Конец последней разобранной строки и причина остановки, если журнал прочитан не весь
+    std::streamoff good_end = 0;
+    bool torn_tail = false;
+    bool stopped = false;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty()) {
+            good_end = ifs.tellg();
+            continue;
+        }
+        json record;
+        // Недописанная последняя запись означает, что транзакция не была подтверждена;
+        // после поврежденной записи журнал тоже не применяется
+        if (!decode_record(line, record)) {
+            torn_tail = ifs.peek() == std::char_traits<char>::eof();
+            if (!torn_tail) std::cerr << "WAL record " << applied + 1 << " is damaged, stopping recovery\n";
+            stopped = true;
+            break;
+        }
+        // Записи без номера сделаны прежней версией и вошли в любой снимок с номером
+        const uint64_t lsn = record.value("lsn", uint64_t{0});
+        if (lsn == 0 ? snapshot_lsn != 0 : lsn <= last_lsn) {
+            good_end = ifs.tellg();
+            continue;
+        }
+        // Пропуск номеров значит, что журнал писался после другого снимка: так бывает,
+        // когда загружен запасной манифест. Записи без предшественников не применяются.
+        if (lsn != 0 && lsn != last_lsn + 1) {
+            std::cerr << "WAL continues from record " << lsn << ", but the snapshot ends at record " << last_lsn
+                      << "; the WAL is not replayed past this point\n";
+            stopped = true;
+            break;
+        }
+
+        std::vector<RedoTable> plan;
+        if (!plan_record(engine, record, plan)) {
+            std::cerr << "WAL record " << applied + 1 << " does not match the snapshot, stopping recovery\n";
+            stopped = true;
+            break;
+        }
+        apply_plan(plan);
+        last_lsn = std::max(last_lsn, lsn);
+        ++applied;
+        good_end = ifs.tellg();
+    }
+    ifs.close();
+
+    // Новые записи не должны оказаться за теми, что не применились: иначе следующее
+    // восстановление остановится раньше них. Журнал обрезается после последней
+    // примененной записи; остаток после ошибки сохраняется рядом для разбора.
+    if (stopped) {
+        if (!torn_tail) {
+            const std::string kept = log_path_ + ".unapplied";
+            std::ifstream tail(log_path_, std::ios::binary);
+            tail.seekg(good_end);
+            std::ofstream out(kept, std::ios::binary | std::ios::trunc);
+            out << tail.rdbuf();
+            if (out.flush()) std::cerr << "Unapplied WAL records are kept in " << kept << "\n";
+        }
+        std::error_code ec;
+        std::filesystem::resize_file(log_path_, static_cast<uintmax_t>(good_end), ec);
+        if (ec) std::cerr << "Cannot truncate the WAL after the last applied record: " << ec.message() << "\n";
+    }
+
+    std::lock_guard lock(mutex_);
+    appended_ = flushed_sequence_ = last_lsn;
+    return applied;
+}
+
+}
@@ -1,9 +1,63 @@
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <stdexcept>
+#include <string_view>
 #include "sql/Parser.hpp"
 #include "net/Server.hpp"
 
-int main() {
-    run_server(5555);
+int main(int argc, char* argv[]) {
+    ServerConfig config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        try {
+            if (arg.rfind("--port=", 0) == 0) {
+                config.port = static_cast<short>(std::stoi(std::string(arg.substr(7))));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                config.threads = std::stoul(std::string(arg.substr(10)));
+            } else if (arg.rfind("--max-connections=", 0) == 0) {
+                config.max_connections = std::stoul(std::string(arg.substr(18)));
+            } else if (arg == "--durable") {
+                config.durable = true;
+            } else if (arg.rfind("--wal-max-delay-us=", 0) == 0) {
+                config.wal_max_delay = std::chrono::microseconds(std::stol(std::string(arg.substr(19))));
+            } else if (arg.rfind("--wal-batch=", 0) == 0) {
+                config.wal_batch_size = std::max<size_t>(1, std::stoul(std::string(arg.substr(12))));
+            } else if (arg == "--wal-relaxed") {
+                config.wal_relaxed = true;
+            } else if (arg.rfind("--metrics-file=", 0) == 0) {
+                config.metrics_file = std::string(arg.substr(15));
+            } else if (arg.rfind("--metrics-interval=", 0) == 0) {
+                config.metrics_interval = std::chrono::seconds(std::max(1, std::stoi(std::string(arg.substr(19)))));
+            } else if (arg.rfind("--slow-log=", 0) == 0) {
+                config.slow_query_file = std::string(arg.substr(11));
+            } else if (arg.rfind("--slow-log-threshold-ms=", 0) == 0) {
+                config.slow_query_threshold = std::chrono::milliseconds(std::max(0, std::stoi(std::string(arg.substr(24)))));
+            } else if (arg.rfind("--memory-limit-mb=", 0) == 0) {
+                config.memory_limit = static_cast<size_t>(std::stoull(std::string(arg.substr(18)))) << 20;
+            } else if (arg.rfind("--auto-analyze=", 0) == 0) {
+                config.auto_analyze_fraction = std::stod(std::string(arg.substr(15)));
+            } else if (arg.rfind("--result-cache-mb=", 0) == 0) {
+                config.result_cache_size = static_cast<size_t>(std::stoull(std::string(arg.substr(18)))) << 20;
+            } else if (arg.rfind("--io-backend=", 0) == 0) {
+                config.io_backend = std::string(arg.substr(13));
+                if (config.io_backend != "auto" && config.io_backend != "uring" && config.io_backend != "posix") {
+                    throw std::invalid_argument("io backend");
+                }
+            } else if (arg == "--io-direct") {
+                config.io_direct = true;
+            } else if (arg.rfind("--copy-dir=", 0) == 0) {
+                config.copy_dir = std::string(arg.substr(11));
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value in argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    run_server(config);
     return 0;
 }
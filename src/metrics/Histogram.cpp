@@ -0,0 +1,86 @@
+#include "metrics/Histogram.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace metrics {
+
+Histogram& Histogram::operator=(const Histogram& other) {
+    if (this != &other) {
+        reset();
+        merge(other);
+    }
+    return *this;
+}
+
+size_t Histogram::index_of(uint64_t value) noexcept {
+    if (value < kSubBuckets) return static_cast<size_t>(value);
+    // Старшие kSubBucketBits битов значения задают корзину внутри диапазона
+    unsigned shift = static_cast<unsigned>(std::bit_width(value)) - kSubBucketBits;
+    size_t index = kSubBuckets + (shift - 1) * (kSubBuckets / 2) + static_cast<size_t>((value >> shift) - kSubBuckets / 2);
+    return std::min(index, kBucketCount - 1);
+}
+
+uint64_t Histogram::highest_equivalent(size_t index) noexcept {
+    if (index < kSubBuckets) return index;
+    size_t range = (index - kSubBuckets) / (kSubBuckets / 2);
+    size_t sub = (index - kSubBuckets) % (kSubBuckets / 2) + kSubBuckets / 2;
+    unsigned shift = static_cast<unsigned>(range) + 1;
+    return ((uint64_t(sub) + 1) << shift) - 1;
+}
+
+void Histogram::record(uint64_t value, uint64_t count) noexcept {
+    counts_[index_of(value)].fetch_add(count, std::memory_order_relaxed);
+    total_.fetch_add(count, std::memory_order_relaxed);
+    sum_.fetch_add(value * count, std::memory_order_relaxed);
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::merge(const Histogram& other) noexcept {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        uint64_t count = other.counts_[i].load(std::memory_order_relaxed);
+        if (count) counts_[i].fetch_add(count, std::memory_order_relaxed);
+    }
+    total_.fetch_add(other.total_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint64_t other_max = other.max();
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (other_max > current && !max_.compare_exchange_weak(current, other_max, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset() noexcept {
+    for (auto& count : counts_) count.store(0, std::memory_order_relaxed);
+    total_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::count() const noexcept {
+    return total_.load(std::memory_order_relaxed);
+}
+
+double Histogram::mean() const noexcept {
+    uint64_t total = count();
+    return total ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / static_cast<double>(total) : 0.0;
+}
+
+uint64_t Histogram::percentile(double percentile) const noexcept {
+    uint64_t total = count();
+    if (total == 0) return 0;
+    // Ранг считается от суммы корзин: при параллельной записи total может ее опережать
+    uint64_t in_buckets = 0;
+    for (const auto& count : counts_) in_buckets += count.load(std::memory_order_relaxed);
+    double fraction = std::clamp(percentile, 0.0, 100.0) / 100.0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(fraction * static_cast<double>(in_buckets) + 0.5));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(highest_equivalent(i), max());
+    }
+    return max();
+}
+
+}
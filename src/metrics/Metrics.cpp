@@ -0,0 +1,174 @@
+#include "metrics/Metrics.hpp"
+#include <memory>
+#include <mutex>
+
+namespace metrics {
+
+namespace {
+
+size_t shard_index() noexcept {
+    static std::atomic<size_t> next{0};
+    thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return index;
+}
+
+struct StatementStats {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> rows_scanned{0};
+    std::atomic<uint64_t> rows_returned{0};
+    Histogram parse_us;
+    Histogram execute_us;
+};
+
+// Область одного потока. Гистограммы видов операторов выделяются при
+// первом использовании, чтобы редкие команды не занимали память в каждом потоке.
+struct ThreadStats {
+    std::array<std::atomic<StatementStats*>, kMaxStatementKinds> statements{};
+
+    ~ThreadStats() {
+        for (auto& stats : statements) delete stats.load(std::memory_order_relaxed);
+    }
+
+    StatementStats& get(size_t kind) {
+        auto* stats = statements[kind].load(std::memory_order_relaxed);
+        if (!stats) {
+            stats = new StatementStats();
+            statements[kind].store(stats, std::memory_order_release);
+        }
+        return *stats;
+    }
+};
+
+// Области живых потоков; области завершившихся потоков сливаются в retired
+// и освобождаются, так что пересоздаваемые потоки пула не копят память
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadStats>> threads;
+    ThreadStats retired;
+    Counter connections_opened;
+    Counter connections_closed;
+    Counter bytes_received;
+    Counter bytes_sent;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+void add_stats(StatementTotals& total, const StatementStats& stats) {
+    total.calls += stats.calls.load(std::memory_order_relaxed);
+    total.errors += stats.errors.load(std::memory_order_relaxed);
+    total.rows_scanned += stats.rows_scanned.load(std::memory_order_relaxed);
+    total.rows_returned += stats.rows_returned.load(std::memory_order_relaxed);
+    total.parse_us.merge(stats.parse_us);
+    total.execute_us.merge(stats.execute_us);
+}
+
+void add_stats(StatementStats& total, const StatementStats& stats) {
+    total.calls.fetch_add(stats.calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.errors.fetch_add(stats.errors.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.rows_scanned.fetch_add(stats.rows_scanned.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.rows_returned.fetch_add(stats.rows_returned.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    total.parse_us.merge(stats.parse_us);
+    total.execute_us.merge(stats.execute_us);
+}
+
+// Владеет областью потока; при завершении потока переносит ее в общий итог
+struct ThreadSlot {
+    ThreadStats* stats = nullptr;
+
+    ~ThreadSlot() {
+        if (!stats) return;
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        for (size_t kind = 0; kind < kMaxStatementKinds; ++kind) {
+            const auto* kind_stats = stats->statements[kind].load(std::memory_order_relaxed);
+            if (!kind_stats) continue;
+            try {
+                add_stats(r.retired.get(kind), *kind_stats);
+            } catch (const std::bad_alloc&) {
+                // Без памяти под итог показатели потока теряются, но область все равно освобождается
+            }
+        }
+        std::erase_if(r.threads, [this](const auto& thread) { return thread.get() == stats; });
+    }
+};
+
+ThreadStats& local_stats() {
+    thread_local ThreadSlot slot;
+    if (!slot.stats) {
+        auto owned = std::make_unique<ThreadStats>();
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        r.threads.push_back(std::move(owned));
+        slot.stats = r.threads.back().get();
+    }
+    return *slot.stats;
+}
+
+}
+
+void Counter::add(uint64_t n) noexcept {
+    cells_[shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+uint64_t Counter::value() const noexcept {
+    uint64_t total = 0;
+    for (const auto& cell : cells_) total += cell.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void record_statement(const StatementSample& sample) noexcept {
+    if (sample.kind >= kMaxStatementKinds) return;
+    try {
+        auto& stats = local_stats().get(sample.kind);
+        stats.calls.fetch_add(1, std::memory_order_relaxed);
+        if (!sample.ok) stats.errors.fetch_add(1, std::memory_order_relaxed);
+        stats.rows_scanned.fetch_add(sample.rows_scanned, std::memory_order_relaxed);
+        stats.rows_returned.fetch_add(sample.rows_returned, std::memory_order_relaxed);
+        stats.parse_us.record(sample.parse_us);
+        stats.execute_us.record(sample.execute_us);
+    } catch (const std::bad_alloc&) {
+        // Без памяти под статистику оператор просто не учитывается
+    }
+}
+
+std::vector<StatementTotals> collect_statements() {
+    std::vector<StatementTotals> totals(kMaxStatementKinds);
+    auto& r = registry();
+    std::lock_guard lock(r.mutex);
+    auto add_thread = [&totals](const ThreadStats& thread) {
+        for (size_t kind = 0; kind < kMaxStatementKinds; ++kind) {
+            const auto* stats = thread.statements[kind].load(std::memory_order_acquire);
+            if (stats) add_stats(totals[kind], *stats);
+        }
+    };
+    add_thread(r.retired);
+    for (const auto& thread : r.threads) add_thread(*thread);
+    return totals;
+}
+
+void connection_opened() noexcept {
+    registry().connections_opened.add();
+}
+
+void connection_closed() noexcept {
+    registry().connections_closed.add();
+}
+
+void add_bytes_received(uint64_t bytes) noexcept {
+    registry().bytes_received.add(bytes);
+}
+
+void add_bytes_sent(uint64_t bytes) noexcept {
+    registry().bytes_sent.add(bytes);
+}
+
+ServerTotals collect_server() {
+    auto& r = registry();
+    return {r.connections_opened.value(), r.connections_closed.value(), r.bytes_received.value(), r.bytes_sent.value()};
+}
+
+}
@@ -0,0 +1,211 @@
+#include "metrics/SlowLog.hpp"
+#include "metrics/RingBuffer.hpp"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+
+namespace metrics {
+
+namespace {
+
+constexpr size_t kRingCapacity = 4096;
+constexpr size_t kMaxFingerprints = 4096;
+constexpr std::chrono::milliseconds kPollInterval{20};
+
+struct SlowLogState {
+    RingBuffer<SlowQuery, kRingCapacity> ring;
+    // Порог в микросекундах, -1 - журнал выключен
+    std::atomic<int64_t> threshold_us{-1};
+    std::atomic<uint64_t> dropped{0};
+
+    std::mutex aggregates_mutex;
+    std::unordered_map<std::string, QueryAggregate> aggregates;
+
+    std::mutex control_mutex;
+    std::jthread writer;
+};
+
+SlowLogState& state() {
+    static SlowLogState instance;
+    return instance;
+}
+
+bool is_word_char(char c) noexcept {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+void aggregate(SlowLogState& s, std::string fp, const SlowQuery& query) {
+    const uint64_t total_us = query.parse_us + query.execute_us;
+    std::lock_guard lock(s.aggregates_mutex);
+    auto it = s.aggregates.find(fp);
+    if (it == s.aggregates.end()) {
+        // Сводка ограничена: вытесняется отпечаток с наименьшим суммарным временем
+        if (s.aggregates.size() >= kMaxFingerprints) {
+            auto victim = std::min_element(s.aggregates.begin(), s.aggregates.end(), [](const auto& a, const auto& b) {
+                return a.second.total_us < b.second.total_us;
+            });
+            s.aggregates.erase(victim);
+        }
+        it = s.aggregates.emplace(fp, QueryAggregate{fp}).first;
+    }
+    auto& entry = it->second;
+    entry.calls++;
+    if (!query.ok) entry.errors++;
+    entry.total_us += total_us;
+    entry.max_us = std::max(entry.max_us, total_us);
+    entry.rows_scanned += query.rows_scanned;
+}
+
+void write_entry(std::ofstream& out, const std::string& fp, const SlowQuery& query) {
+    const auto finished_ms = std::chrono::duration_cast<std::chrono::milliseconds>(query.finished.time_since_epoch());
+    nlohmann::json line = {
+        {"time_ms", finished_ms.count()},
+        {"database", query.database},
+        {"fingerprint", fp},
+        {"query", query.query},
+        {"ok", query.ok},
+        {"parse_us", query.parse_us},
+        {"execute_us", query.execute_us},
+        {"total_us", query.parse_us + query.execute_us},
+        {"rows_scanned", query.rows_scanned},
+        {"rows_returned", query.rows_returned},
+    };
+    out << line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+}
+
+void drain(SlowLogState& s, std::ofstream& out) {
+    bool written = false;
+    while (auto query = s.ring.try_pop()) {
+        std::string fp = fingerprint(query->query);
+        if (out.is_open()) {
+            write_entry(out, fp, *query);
+            written = true;
+        }
+        aggregate(s, std::move(fp), *query);
+    }
+    if (written) out.flush();
+}
+
+void run_writer(std::stop_token stop, std::string path) {
+    auto& s = state();
+    std::ofstream out;
+    if (!path.empty()) {
+        out.open(path, std::ios::app);
+        if (!out) std::cerr << "Cannot open slow query log " << path << std::endl;
+    }
+
+    // Буфер опрашивается периодически: поток запроса никого не будит
+    std::mutex mutex;
+    std::condition_variable_any wakeup;
+    std::unique_lock lock(mutex);
+    do {
+        drain(s, out);
+    } while (!wakeup.wait_for(lock, stop, kPollInterval, [&stop] { return stop.stop_requested(); }));
+    drain(s, out);
+}
+
+}
+
+std::string fingerprint(std::string_view query) {
+    std::string out;
+    out.reserve(query.size());
+    bool space = false;
+    auto emit = [&](std::string_view token) {
+        if (space && !out.empty()) out += ' ';
+        space = false;
+        out += token;
+    };
+
+    size_t i = 0;
+    while (i < query.size()) {
+        const char c = query[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            ++i;
+        } else if (c == '"' || c == '\'') {
+            size_t end = query.find(c, i + 1);
+            i = end == std::string_view::npos ? query.size() : end + 1;
+            emit("?");
+        } else if (is_word_char(c) && !std::isdigit(static_cast<unsigned char>(c))) {
+            size_t start = i;
+            while (i < query.size() && is_word_char(query[i])) ++i;
+            std::string word(query.substr(start, i - start));
+            std::string upper = word;
+            std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+            emit(upper == "TRUE" || upper == "FALSE" ? "?" : word);
+        } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                   ((c == '-' || c == '.') && i + 1 < query.size() && std::isdigit(static_cast<unsigned char>(query[i + 1])) &&
+                    (out.empty() || (!is_word_char(out.back()) && out.back() != '?' && out.back() != ')')))) {
+            ++i;
+            while (i < query.size() && (std::isdigit(static_cast<unsigned char>(query[i])) || query[i] == '.')) ++i;
+            emit("?");
+        } else if (c == '$') {
+            // Параметры подготовленного запроса остаются как есть
+            size_t start = i++;
+            while (i < query.size() && std::isdigit(static_cast<unsigned char>(query[i]))) ++i;
+            emit(query.substr(start, i - start));
+        } else {
+            emit(query.substr(i, 1));
+            ++i;
+        }
+    }
+    while (!out.empty() && out.back() == ';') out.pop_back();
+    return out;
+}
+
+void start_slow_log(const SlowLogOptions& options) {
+    auto& s = state();
+    std::lock_guard lock(s.control_mutex);
+    if (s.writer.joinable()) return;
+    s.writer = std::jthread(run_writer, options.path);
+    s.threshold_us.store(options.threshold.count(), std::memory_order_relaxed);
+}
+
+void stop_slow_log() {
+    auto& s = state();
+    std::lock_guard lock(s.control_mutex);
+    s.threshold_us.store(-1, std::memory_order_relaxed);
+    if (s.writer.joinable()) {
+        s.writer.request_stop();
+        s.writer.join();
+    }
+}
+
+bool is_slow(uint64_t total_us) noexcept {
+    const int64_t threshold = state().threshold_us.load(std::memory_order_relaxed);
+    return threshold >= 0 && total_us >= static_cast<uint64_t>(threshold);
+}
+
+void log_slow_query(SlowQuery query) noexcept {
+    auto& s = state();
+    if (!s.ring.try_push(std::move(query))) s.dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<QueryAggregate> top_queries(size_t limit) {
+    std::vector<QueryAggregate> result;
+    {
+        auto& s = state();
+        std::lock_guard lock(s.aggregates_mutex);
+        result.reserve(s.aggregates.size());
+        for (const auto& [fp, entry] : s.aggregates) result.push_back(entry);
+    }
+    const size_t count = std::min(limit, result.size());
+    std::partial_sort(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(count), result.end(),
+                      [](const QueryAggregate& a, const QueryAggregate& b) { return a.total_us > b.total_us; });
+    result.resize(count);
+    return result;
+}
+
+uint64_t slow_queries_dropped() noexcept {
+    return state().dropped.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,181 @@
+#include "net/Protocol.hpp"
+#include <bit>
+#include <cstring>
+
+namespace net {
+
+namespace {
+
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view data) : data_(data) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (data_.size() - pos_ < sizeof(T)) return false;
+        uint64_t raw = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            raw |= uint64_t(static_cast<unsigned char>(data_[pos_ + i])) << (8 * i);
+        }
+        pos_ += sizeof(T);
+        if constexpr (std::is_same_v<T, float>) {
+            value = std::bit_cast<float>(static_cast<uint32_t>(raw));
+        } else {
+            value = static_cast<T>(raw);
+        }
+        return true;
+    }
+
+    bool read_bytes(size_t count, std::string& out) {
+        if (data_.size() - pos_ < count) return false;
+        out.assign(data_.data() + pos_, count);
+        pos_ += count;
+        return true;
+    }
+
+    bool at_end() const noexcept { return pos_ == data_.size(); }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+};
+
+template <typename T>
+void write_le(std::string& out, T value) {
+    uint64_t raw;
+    if constexpr (std::is_same_v<T, float>) {
+        raw = std::bit_cast<uint32_t>(value);
+    } else {
+        raw = static_cast<uint64_t>(value);
+    }
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((raw >> (8 * i)) & 0xFF));
+    }
+}
+
+}
+
+bool append_frame(std::string& out, MessageType type, std::string_view payload) {
+    if (payload.size() >= kMaxFrameSize) return false;
+    uint32_t length = static_cast<uint32_t>(payload.size() + 1);
+    out.push_back(static_cast<char>((length >> 24) & 0xFF));
+    out.push_back(static_cast<char>((length >> 16) & 0xFF));
+    out.push_back(static_cast<char>((length >> 8) & 0xFF));
+    out.push_back(static_cast<char>(length & 0xFF));
+    out.push_back(static_cast<char>(type));
+    out.append(payload);
+    return true;
+}
+
+DecodeStatus decode_frame(std::string_view buffer, Frame& frame, size_t& consumed) {
+    if (buffer.size() < kFrameHeaderSize) return DecodeStatus::INCOMPLETE;
+
+    const auto* p = reinterpret_cast<const unsigned char*>(buffer.data());
+    uint32_t length = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    if (length == 0 || length > kMaxFrameSize) return DecodeStatus::INVALID;
+    if (buffer.size() < 4 + size_t(length)) return DecodeStatus::INCOMPLETE;
+
+    frame.type = static_cast<MessageType>(p[4]);
+    frame.payload.assign(buffer.data() + kFrameHeaderSize, length - 1);
+    consumed = 4 + size_t(length);
+    return DecodeStatus::COMPLETE;
+}
+
+bool decode_prepare(std::string_view payload, PrepareRequest& request) {
+    size_t separator = payload.find('\0');
+    if (separator == std::string_view::npos || separator == 0) return false;
+    request.name.assign(payload.substr(0, separator));
+    request.query.assign(payload.substr(separator + 1));
+    return true;
+}
+
+bool decode_execute(std::string_view payload, ExecuteRequest& request) {
+    PayloadReader reader(payload);
+    uint8_t flags = 0;
+    uint16_t name_length = 0;
+    uint16_t count = 0;
+    if (!reader.read(flags) || !reader.read(name_length) || !reader.read_bytes(name_length, request.name) ||
+        !reader.read(count)) {
+        return false;
+    }
+    request.binary = flags & 1;
+
+    request.params.clear();
+    request.params.reserve(count);
+    for (uint16_t i = 0; i < count; ++i) {
+        uint8_t type = 0;
+        if (!reader.read(type)) return false;
+        switch (type) {
+        case 0:
+            request.params.emplace_back(db::NullValue{});
+            break;
+        case 1: {
+            int32_t v;
+            if (!reader.read(v)) return false;
+            request.params.emplace_back(static_cast<int>(v));
+            break;
+        }
+        case 2: {
+            float v;
+            if (!reader.read(v)) return false;
+            request.params.emplace_back(v);
+            break;
+        }
+        case 3: {
+            uint8_t v;
+            if (!reader.read(v)) return false;
+            request.params.emplace_back(v != 0);
+            break;
+        }
+        case 4: {
+            uint32_t length;
+            std::string v;
+            if (!reader.read(length) || !reader.read_bytes(length, v)) return false;
+            request.params.emplace_back(std::move(v));
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return reader.at_end();
+}
+
+bool append_prepare(std::string& out, const PrepareRequest& request) {
+    std::string payload = request.name;
+    payload.push_back('\0');
+    payload += request.query;
+    return append_frame(out, MessageType::PREPARE, payload);
+}
+
+bool append_execute(std::string& out, const ExecuteRequest& request) {
+    std::string payload;
+    write_le(payload, static_cast<uint8_t>(request.binary ? 1 : 0));
+    write_le(payload, static_cast<uint16_t>(request.name.size()));
+    payload += request.name;
+    write_le(payload, static_cast<uint16_t>(request.params.size()));
+    for (const auto& param : request.params) {
+        std::visit([&payload](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, int>) {
+                write_le(payload, uint8_t(1));
+                write_le(payload, static_cast<int32_t>(v));
+            } else if constexpr (std::is_same_v<T, float>) {
+                write_le(payload, uint8_t(2));
+                write_le(payload, v);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                write_le(payload, uint8_t(3));
+                write_le(payload, static_cast<uint8_t>(v ? 1 : 0));
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                write_le(payload, uint8_t(4));
+                write_le(payload, static_cast<uint32_t>(v.size()));
+                payload += v;
+            } else {
+                write_le(payload, uint8_t(0));
+            }
+        }, param);
+    }
+    return append_frame(out, MessageType::EXECUTE, payload);
+}
+
+}
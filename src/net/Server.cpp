@@ -1,125 +1,712 @@
 #include <asio.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <thread>
 #include <iostream>
 #include <atomic>
 #include <string>
-#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "net/Server.hpp"
 #include "sql/Parser.hpp"
 #include "db/StorageEngine.hpp"
 #include "db/StorageEngineIO.hpp"
+#include "db/WriteAheadLog.hpp"
+#include "db/MemoryTracker.hpp"
+#include "db/Statistics.hpp"
+#include "db/IOBackend.hpp"
+#include "db/RwLock.hpp"
 #include "sql/Executor.hpp"
+#include "sql/ResultCache.hpp"
+#include "net/Protocol.hpp"
+#include "sql/executors/ShowExecutor.hpp"
+#include "sql/executors/CopyExecutor.hpp"
+#include "metrics/Metrics.hpp"
+#include "metrics/SlowLog.hpp"
 
 using asio::ip::tcp;
 
 namespace {
 
 constexpr std::string_view dbfile = "dbdata.json";
-std::atomic<bool> running{true};
+constexpr std::string_view walfile = "dbdata.wal";
+constexpr size_t kReadBufferSize = 64 * 1024;
+constexpr std::string_view kTooManyConnections = "Error: too many connections\n";
 db::StorageEngine engine;
 
-void console_handler() {
-    std::string input;
-    while (running) {
-        std::getline(std::cin, input);
-        if (input == "stop" || input == "quit" || input == "exit") {
-            std::cout << "Stopping server...\n";
-            running = false;
-            break;
+struct QueryResponse {
+    net::MessageType type;
+    std::string body;
+    // body уже разбит на кадры (бинарный результат)
+    bool framed = false;
+    // Ответ на фиксацию отправляется после сброса ее записи в WAL
+    db::PendingCommit pending_commit{};
+};
+
+uint64_t elapsed_us(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count());
+}
+
+// Для EXECUTE в журнал попадает текст подготовленного запроса
+std::string statement_text(const sql::ParseResult& res, const sql::Session& session, std::string_view query) {
+    if (res.type == sql::CommandType::EXECUTE) {
+        auto it = session.prepared.find(std::get<sql::Execute>(res.command).name);
+        if (it != session.prepared.end()) return it->second.query;
+    }
+    if (query.empty() && res.type == sql::CommandType::PREPARE) {
+        const auto& cmd = std::get<sql::Prepare>(res.command);
+        return "PREPARE " + cmd.name + " AS " + cmd.query;
+    }
+    return std::string(query);
+}
+
+QueryResponse run_statement(const sql::ParseResult& res, sql::Session& session, bool binary,
+                            std::string_view query = {}, uint64_t parse_us = 0) {
+    auto started = std::chrono::steady_clock::now();
+    const auto cached = sql::cached_query(res, session, query, binary);
+    const auto result_type = binary ? net::MessageType::RESULT_BINARY : net::MessageType::RESULT;
+    sql::ResultCache::Ticket ticket;
+    if (cached) {
+        if (auto body = sql::ResultCache::lookup(*cached, engine, ticket)) {
+            metrics::record_statement({static_cast<size_t>(res.type), true, parse_us, elapsed_us(started), 0, 0});
+            return {result_type, std::move(*body), binary};
         }
     }
+
+    auto exec = sql::Executor::execute(res, engine, session, true);
+    const uint64_t execute_us = elapsed_us(started);
+    metrics::record_statement({static_cast<size_t>(res.type), exec.ok, parse_us, execute_us,
+                               exec.rows_scanned, exec.result_set.row_count()});
+    if (metrics::is_slow(parse_us + execute_us)) {
+        metrics::log_slow_query({statement_text(res, session, query), session.current_db,
+                                 std::chrono::system_clock::now(), parse_us, execute_us,
+                                 exec.rows_scanned, exec.result_set.row_count(), exec.ok});
+    }
+    if (!exec.ok) {
+        return {net::MessageType::ERROR, "Error: " + exec.error + "\n"};
+    }
+    if (exec.result_set.column_count() > 0) {
+        QueryResponse response{result_type, {}, binary};
+        if (binary) {
+            bool serialized = exec.result_set.serialize_binary(net::kMaxFrameSize - 1, [&](std::string_view payload) {
+                return net::append_frame(response.body, result_type, payload);
+            });
+            if (!serialized) return {net::MessageType::ERROR, "Error: result row exceeds the maximum frame size\n"};
+        } else {
+            response.body = exec.result_set.to_text();
+        }
+        if (cached) sql::ResultCache::store(*cached, ticket, response.body);
+        return response;
+    }
+    return {net::MessageType::OK, "OK\n", false, std::move(exec.pending_commit)};
 }
 
-void session(tcp::socket sock) {
-    try {
-        for (;;) {
-            std::string data(1024, '\0');
-            asio::error_code error;
-            size_t length = sock.read_some(asio::buffer(data), error);
-            if (error == asio::error::eof) break;
-            if (error) throw asio::system_error(error);
-
-            data.resize(length);
-            auto res = sql::Parser::parse(data);
-            std::string response;
-            if (!res.valid) {
-                response = "Parse error: " + res.error + "\n";
-            } else {
-                auto exec = sql::Executor::execute(res, engine);
-                if (exec.ok) {
-                    if (res.type == sql::CommandType::SELECT) {
-                        response = exec.result;
-                    } else {
-                        response = "OK\n";
-                    }
-                } else {
-                    response = "Error: " + exec.error + "\n";
-                }
-            }
-            asio::write(sock, asio::buffer(response), error);
-            if (error) break;
+QueryResponse handle_query(const std::string& query, sql::Session& session, bool binary = false) {
+    auto started = std::chrono::steady_clock::now();
+    auto res = sql::Parser::parse(query);
+    uint64_t parse_us = elapsed_us(started);
+    if (!res.valid) {
+        metrics::record_statement({static_cast<size_t>(res.type), false, parse_us, 0, 0, 0});
+        return {net::MessageType::ERROR, "Parse error: " + res.error + "\n"};
+    }
+    return run_statement(res, session, binary, query, parse_us);
+}
+
+QueryResponse handle_frame(const net::Frame& frame, sql::Session& session) {
+    switch (frame.type) {
+    case net::MessageType::QUERY:
+        return handle_query(frame.payload, session);
+    case net::MessageType::QUERY_BINARY:
+        return handle_query(frame.payload, session, true);
+    case net::MessageType::PREPARE: {
+        net::PrepareRequest request;
+        if (!net::decode_prepare(frame.payload, request)) break;
+        return run_statement({sql::CommandType::PREPARE, sql::Prepare{request.name, request.query}, true, ""}, session, false);
+    }
+    case net::MessageType::EXECUTE: {
+        net::ExecuteRequest request;
+        if (!net::decode_execute(frame.payload, request)) break;
+        return run_statement({sql::CommandType::EXECUTE, sql::Execute{request.name, std::move(request.params)}, true, ""},
+                             session, request.binary);
+    }
+    default:
+        return {net::MessageType::ERROR, "Error: unsupported message type\n"};
+    }
+    return {net::MessageType::ERROR, "Error: malformed message\n"};
+}
+
+// Пул потоков для выполнения операторов. Оператор может до kLockTimeout ждать
+// блокировку таблицы, и на потоках io_context это останавливало бы ввод-вывод
+// всех соединений. Пул держит threads потоков, не занятых ожиданием: поток,
+// который ждет RwLock, сообщает об этом, и если есть задачи в очереди, пул
+// запускает ему замену. Иначе операторы, ждущие блокировок транзакции, заняли бы
+// все потоки, и ее COMMIT не дождался бы очереди. Лишние потоки завершаются после простоя.
+class StatementPool : private db::LockWaitObserver {
+public:
+    explicit StatementPool(size_t threads) : min_threads_(std::max<size_t>(threads, 1)) {}
+    ~StatementPool();
+
+    StatementPool(const StatementPool&) = delete;
+    StatementPool& operator=(const StatementPool&) = delete;
+
+    void post(std::function<void()> task);
+
+private:
+    static constexpr std::chrono::seconds kIdleTimeout{30};
+
+    void wait_started() override;
+    void wait_finished() override;
+    // Запускает поток, если задачам в очереди не хватает свободных потоков
+    // и работающих без ожидания меньше min_threads_; вызывается под mutex_
+    void spawn_if_needed();
+    void worker();
+
+    const size_t min_threads_;
+    std::mutex mutex_;
+    std::condition_variable queued_;
+    std::condition_variable finished_;
+    std::deque<std::function<void()>> tasks_;
+    size_t threads_ = 0;
+    size_t idle_ = 0;
+    size_t waiting_ = 0;
+    bool stopping_ = false;
+};
+
+StatementPool::~StatementPool() {
+    std::unique_lock lock(mutex_);
+    stopping_ = true;
+    queued_.notify_all();
+    finished_.wait(lock, [this] { return threads_ == 0; });
+}
+
+void StatementPool::post(std::function<void()> task) {
+    std::lock_guard lock(mutex_);
+    tasks_.push_back(std::move(task));
+    spawn_if_needed();
+    queued_.notify_one();
+}
+
+void StatementPool::wait_started() {
+    std::lock_guard lock(mutex_);
+    ++waiting_;
+    spawn_if_needed();
+}
+
+void StatementPool::wait_finished() {
+    std::lock_guard lock(mutex_);
+    --waiting_;
+}
+
+void StatementPool::spawn_if_needed() {
+    if (stopping_ || tasks_.size() <= idle_ || threads_ - waiting_ >= min_threads_) return;
+    ++threads_;
+    std::thread(&StatementPool::worker, this).detach();
+}
+
+void StatementPool::worker() {
+    db::RwLock::set_wait_observer(this);
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        ++idle_;
+        bool woken = queued_.wait_for(lock, kIdleTimeout, [this] { return stopping_ || !tasks_.empty(); });
+        --idle_;
+        if (tasks_.empty() && (stopping_ || (!woken && threads_ - waiting_ > min_threads_))) break;
+        if (tasks_.empty()) continue;
+
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+        task = nullptr;
+        lock.lock();
+    }
+    --threads_;
+    finished_.notify_all();
+}
+
+class Server;
+
+// Соединение обслуживается цепочкой асинхронных операций на своем strand:
+// чтение -> выполнение всех полученных запросов в пуле операторов -> одна запись -> чтение.
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(tcp::socket socket, Server& server);
+    ~Connection();
+
+    void start();
+    void stop();
+
+private:
+    enum class Mode { UNKNOWN, LEGACY, FRAMED };
+
+    void do_read();
+    void on_read(const asio::error_code& error, size_t length);
+    void schedule_execute();
+    void execute();
+    void on_executed();
+    bool process_framed();
+    void append_response(const QueryResponse& response);
+    void wait_durable();
+    void on_durable(bool durable);
+    void do_write();
+    void close();
+
+    tcp::socket socket_;
+    Server& server_;
+    std::vector<char> read_buffer_;
+    std::string pending_;
+    std::string out_;
+    sql::Session session_;
+    Mode mode_ = Mode::UNKNOWN;
+    bool reading_ = false;
+    bool closing_ = false;
+    // Пишутся в пуле операторов, читаются на strand после их выполнения
+    bool invalid_frame_ = false;
+    // Ответ на фиксацию, ждущий сброса WAL; следующие запросы ждут вместе с ним
+    QueryResponse durable_response_;
+};
+
+class Server {
+public:
+    Server(asio::io_context& io_context, const ServerConfig& config);
+
+    void start();
+    void shutdown();
+
+    bool is_stopping() const noexcept { return stopping_; }
+    void remove_connection(Connection* connection);
+    StatementPool& statements() noexcept { return statements_; }
+
+private:
+    void do_accept();
+
+    asio::io_context& io_context_;
+    ServerConfig config_;
+    // Прием соединений, сигналы и остановка идут на одном strand: сокет приемника
+    // не потокобезопасен, а io_context работает в нескольких потоках
+    asio::strand<asio::io_context::executor_type> strand_;
+    tcp::acceptor acceptor_;
+    asio::signal_set signals_;
+    std::atomic<bool> stopping_{false};
+    std::mutex connections_mutex_;
+    std::unordered_map<Connection*, std::weak_ptr<Connection>> connections_;
+    StatementPool statements_;
+};
+
+Connection::Connection(tcp::socket socket, Server& server)
+    : socket_(std::move(socket)), server_(server), read_buffer_(kReadBufferSize) {
+    metrics::connection_opened();
+}
+
+Connection::~Connection() {
+    server_.remove_connection(this);
+    metrics::connection_closed();
+}
+
+void Connection::start() {
+    asio::dispatch(socket_.get_executor(), [self = shared_from_this()]() { self->do_read(); });
+}
+
+void Connection::stop() {
+    asio::post(socket_.get_executor(), [self = shared_from_this()]() {
+        self->closing_ = true;
+        // Соединение, которое сейчас выполняет запросы, закроется после записи ответа
+        if (self->reading_) self->close();
+    });
+}
+
+void Connection::close() {
+    asio::error_code ignored;
+    socket_.shutdown(tcp::socket::shutdown_both, ignored);
+    socket_.close(ignored);
+}
+
+void Connection::do_read() {
+    if (closing_) {
+        close();
+        return;
+    }
+    reading_ = true;
+    socket_.async_read_some(asio::buffer(read_buffer_),
+        [self = shared_from_this()](const asio::error_code& error, size_t length) {
+            self->on_read(error, length);
+        });
+}
+
+void Connection::on_read(const asio::error_code& error, size_t length) {
+    reading_ = false;
+    if (error) {
+        if (error != asio::error::eof && error != asio::error::operation_aborted) {
+            std::cerr << "Session error: " << error.message() << std::endl;
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Session error: " << e.what() << std::endl;
+        close();
+        return;
     }
+    pending_.append(read_buffer_.data(), length);
+    metrics::add_bytes_received(length);
+
+    if (mode_ == Mode::UNKNOWN) {
+        // Ждем, пока не станет ясно, начинается ли поток с handshake
+        if (pending_.size() < net::kHandshake.size() && net::kHandshake.substr(0, pending_.size()) == pending_) {
+            do_read();
+            return;
+        }
+        if (pending_.compare(0, net::kHandshake.size(), net::kHandshake) == 0) {
+            mode_ = Mode::FRAMED;
+            pending_.erase(0, net::kHandshake.size());
+            out_.assign(net::kHandshake);
+        } else {
+            mode_ = Mode::LEGACY;
+        }
+    }
+
+    schedule_execute();
 }
 
+void Connection::schedule_execute() {
+    // Пока запросы выполняются, у соединения нет операций ввода-вывода, а
+    // work guard не дает io_context завершиться до ответа
+    server_.statements().post([self = shared_from_this(), work = asio::make_work_guard(socket_.get_executor())]() {
+        self->execute();
+        asio::post(work.get_executor(), [self]() { self->on_executed(); });
+    });
 }
 
-void run_server(short port) {
-    // Загрузка БД
-    if (!db::load_from_file(engine, dbfile)) {
-        std::cout << "No DB file, starting fresh\n";
+void Connection::execute() {
+    if (mode_ == Mode::LEGACY) {
+        // Старый текстовый режим: одно чтение - один запрос
+        auto response = handle_query(pending_, session_);
+        pending_.clear();
+        if (response.pending_commit.sequence != 0) {
+            durable_response_ = std::move(response);
+        } else {
+            out_ = std::move(response.body);
+        }
     } else {
-        std::cout << "DB loaded\n";
+        invalid_frame_ = !process_framed();
     }
+}
 
-    asio::io_context io_context;
-    tcp::acceptor acceptor(io_context, tcp::endpoint(tcp::v4(), port));
-    std::cout << "Server started on port " << port << std::endl;
-    std::cout << "Type 'stop' to shutdown server\n";
+void Connection::on_executed() {
+    if (durable_response_.pending_commit.sequence != 0) {
+        wait_durable();
+        return;
+    }
+    if (invalid_frame_) closing_ = true;
+    if (out_.empty()) {
+        do_read();
+    } else {
+        do_write();
+    }
+}
 
-    std::thread console_thread(console_handler);
+// Framed-режим: все полученные кадры выполняются подряд, ответы уходят одним write.
+// Фиксация, ждущая сброса WAL, прерывает выполнение: остальные кадры ждут ее ответа.
+// Возвращает false, если поток кадров поврежден
+bool Connection::process_framed() {
+    net::Frame frame;
+    size_t offset = 0;
+    size_t consumed = 0;
+    net::DecodeStatus status;
+    while ((status = net::decode_frame(std::string_view(pending_).substr(offset), frame, consumed)) == net::DecodeStatus::COMPLETE) {
+        offset += consumed;
+        auto response = handle_frame(frame, session_);
+        if (response.pending_commit.sequence != 0) {
+            durable_response_ = std::move(response);
+            pending_.erase(0, offset);
+            return true;
+        }
+        append_response(response);
+    }
+    pending_.erase(0, offset);
 
-    // Асинхронный accept с лямбдой
-    std::function<void()> do_accept;
-    std::atomic<bool> accept_in_progress{false};
+    if (status == net::DecodeStatus::INVALID) {
+        std::cerr << "Session error: invalid frame" << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    do_accept = [&]() {
-        if (!running) return;
+void Connection::append_response(const QueryResponse& response) {
+    if (mode_ == Mode::LEGACY) {
+        out_ += response.body;
+    } else if (response.framed) {
+        out_ += response.body;
+    } else if (!net::append_frame(out_, response.type, response.body)) {
+        static constexpr std::string_view kTooLarge = "Error: result exceeds the maximum frame size, use the binary format\n";
+        (void)net::append_frame(out_, net::MessageType::ERROR, kTooLarge);
+    }
+}
 
-        accept_in_progress = true;
-        auto socket = std::make_shared<tcp::socket>(io_context);
+// Ожидание fsync не занимает поток пула: поток сброса WAL завершает версию
+// фиксации и возвращает соединение на strand, а групповая фиксация собирает
+// все ждущие сессии
+void Connection::wait_durable() {
+    auto pending = std::exchange(durable_response_.pending_commit, {});
+    engine.get_wal()->on_durable(pending.sequence,
+        [self = shared_from_this(), work = asio::make_work_guard(socket_.get_executor()),
+         version = std::move(pending.version)](bool durable) mutable {
+            version.reset();
+            asio::post(work.get_executor(), [self, durable]() { self->on_durable(durable); });
+        });
+}
 
-        acceptor.async_accept(*socket, [&, socket](const asio::error_code& error) {
-            accept_in_progress = false;
+void Connection::on_durable(bool durable) {
+    if (!durable) {
+        durable_response_ = {net::MessageType::ERROR, "Error: " + std::string(db::kUnknownCommitOutcome) + "\n"};
+    }
+    append_response(durable_response_);
+    durable_response_ = {};
+    if (mode_ == Mode::FRAMED && !pending_.empty()) {
+        schedule_execute();
+    } else {
+        on_executed();
+    }
+}
 
-            if (!error) {
-                std::thread(session, std::move(*socket)).detach();
-                do_accept();
-            } else if (error != asio::error::operation_aborted) {
-                std::cerr << "Accept error: " << error.message() << std::endl;
+void Connection::do_write() {
+    metrics::add_bytes_sent(out_.size());
+    asio::async_write(socket_, asio::buffer(out_),
+        [self = shared_from_this()](const asio::error_code& error, size_t) {
+            self->out_.clear();
+            if (error) {
+                self->close();
+                return;
             }
+            self->do_read();
         });
-    };
+}
 
+Server::Server(asio::io_context& io_context, const ServerConfig& config)
+    : io_context_(io_context),
+      config_(config),
+      strand_(asio::make_strand(io_context)),
+      acceptor_(strand_, tcp::endpoint(tcp::v4(), config.port)),
+      signals_(strand_, SIGINT, SIGTERM),
+      statements_(config.threads) {}
+
+void Server::start() {
+    signals_.async_wait([this](const asio::error_code& error, int) {
+        if (!error) shutdown();
+    });
     do_accept();
+}
+
+void Server::do_accept() {
+    acceptor_.async_accept(asio::make_strand(io_context_), [this](const asio::error_code& error, tcp::socket socket) {
+        if (error) {
+            if (error != asio::error::operation_aborted) {
+                std::cerr << "Accept error: " << error.message() << std::endl;
+            }
+            if (!stopping_) do_accept();
+            return;
+        }
+
+        std::shared_ptr<Connection> connection;
+        {
+            std::lock_guard lock(connections_mutex_);
+            if (!stopping_ && connections_.size() < config_.max_connections) {
+                connection = std::make_shared<Connection>(std::move(socket), *this);
+                connections_.emplace(connection.get(), connection);
+            }
+        }
+
+        if (connection) {
+            connection->start();
+        } else {
+            auto rejected = std::make_shared<tcp::socket>(std::move(socket));
+            asio::async_write(*rejected, asio::buffer(kTooManyConnections),
+                [rejected](const asio::error_code&, size_t) {
+                    asio::error_code ignored;
+                    rejected->close(ignored);
+                });
+        }
+
+        if (!stopping_) do_accept();
+    });
+}
+
+void Server::shutdown() {
+    asio::post(strand_, [this]() {
+        if (stopping_.exchange(true)) return;
+
+        asio::error_code ignored;
+        acceptor_.close(ignored);
+        signals_.cancel(ignored);
+
+        std::vector<std::shared_ptr<Connection>> active;
+        {
+            std::lock_guard lock(connections_mutex_);
+            for (auto& [ptr, weak] : connections_) {
+                if (auto connection = weak.lock()) active.push_back(std::move(connection));
+            }
+        }
+        for (auto& connection : active) connection->stop();
+    });
+}
+
+void Server::remove_connection(Connection* connection) {
+    std::lock_guard lock(connections_mutex_);
+    connections_.erase(connection);
+}
+
+// Снимок метрик пишется во временный файл и подменяет прежний целиком
+void write_metrics_file(const std::string& path) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::trunc);
+        for (const auto& line : sql::executors::collect_metrics(engine)) {
+            ofs << line.name << ' ' << line.value << '\n';
+        }
+        if (!ofs) {
+            std::cerr << "Cannot write metrics to " << tmp << std::endl;
+            return;
+        }
+    }
+    std::rename(tmp.c_str(), path.c_str());
+}
 
-    // Основной цикл обработки событий
-    while (running) {
-        io_context.poll();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+std::mutex shutdown_mutex;
+Server* active_server = nullptr;
+
+void request_shutdown() {
+    std::lock_guard lock(shutdown_mutex);
+    if (active_server) active_server->shutdown();
+}
+
+void console_handler() {
+    std::string input;
+    while (std::getline(std::cin, input)) {
+        if (input == "stop" || input == "quit" || input == "exit") {
+            std::cout << "Stopping server...\n";
+            request_shutdown();
+            break;
+        }
     }
+}
+
+}
 
-    // Завершение работы
-    acceptor.cancel();
-    acceptor.close();
-    io_context.stop();
-    io_context.poll();
+void run_server(short port) {
+    ServerConfig config;
+    config.port = port;
+    run_server(config);
+}
 
-    if (console_thread.joinable())
-        console_thread.join();
+void run_server(const ServerConfig& config) {
+    // Загрузка БД
+    db::MemoryTracker::set_limit(config.memory_limit);
+    db::AutoAnalyze::set_fraction(config.auto_analyze_fraction);
+    sql::ResultCache::set_capacity(config.result_cache_size);
+    db::IOOptions io;
+    io.kind = config.io_backend == "uring" ? db::IOBackendKind::URING
+            : config.io_backend == "posix" ? db::IOBackendKind::POSIX
+                                           : db::IOBackendKind::AUTO;
+    io.direct = config.io_direct;
+    db::IOConfig::set(io);
+    std::string copy_error;
+    if (!sql::executors::CopyDirectory::set(config.copy_dir, copy_error)) {
+        std::cerr << copy_error << std::endl;
+        return;
+    }
+    std::cout << "I/O backend: " << db::make_io_backend()->name() << "\n";
+    // Поврежденный снимок без исправного запасного не заменяется пустой базой
+    uint64_t snapshot_lsn = 0;
+    try {
+        std::vector<db::LoadedTableInfo> tables;
+        if (!db::load_from_file(engine, dbfile, &snapshot_lsn, &tables)) {
+            std::cout << "No DB file, starting fresh\n";
+        } else {
+            for (const auto& table : tables) {
+                std::cout << "Loaded table " << table.database << "." << table.table << " (" << table.rows
+                          << " rows) in " << table.elapsed.count() << " ms\n";
+            }
+            std::cout << "DB loaded\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Cannot load database: " << e.what() << std::endl;
+        return;
+    }
+
+    std::unique_ptr<db::WriteAheadLog> wal;
+    if (config.durable) {
+        db::WalOptions options;
+        options.max_delay = config.wal_max_delay;
+        options.batch_size = config.wal_batch_size;
+        options.relaxed = config.wal_relaxed;
+        wal = std::make_unique<db::WriteAheadLog>(std::string(dbfile), std::string(walfile), options);
+        if (size_t recovered = wal->recover(engine, snapshot_lsn)) {
+            std::cout << "Recovered " << recovered << " transaction(s) from WAL\n";
+        }
+        if (!wal->open()) {
+            std::cerr << "Cannot open WAL file " << walfile << std::endl;
+            return;
+        }
+        engine.set_wal(wal.get());
+    }
+
+    asio::io_context io_context;
+    Server server(io_context, config);
+    server.start();
+
+    const size_t thread_count = std::max<size_t>(config.threads, 1);
+    std::cout << "Server started on port " << config.port << " (" << thread_count << " worker threads)" << std::endl;
+    std::cout << "Type 'stop' to shutdown server\n";
+
+    {
+        std::lock_guard lock(shutdown_mutex);
+        active_server = &server;
+    }
+    std::thread(console_handler).detach();
+
+    metrics::start_slow_log({config.slow_query_file, config.slow_query_threshold});
+
+    std::jthread metrics_writer;
+    if (!config.metrics_file.empty()) {
+        metrics_writer = std::jthread([&config](std::stop_token stop) {
+            std::mutex mutex;
+            std::condition_variable_any wakeup;
+            std::unique_lock lock(mutex);
+            do {
+                write_metrics_file(config.metrics_file);
+            } while (!wakeup.wait_for(lock, stop, config.metrics_interval, [&stop] { return stop.stop_requested(); }));
+            write_metrics_file(config.metrics_file);
+        });
+    }
+
+    // io_context::run() завершится, когда закроются acceptor и все соединения
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < thread_count; ++i) {
+        workers.emplace_back([&io_context]() { io_context.run(); });
+    }
+    io_context.run();
+    for (auto& worker : workers) worker.join();
+    if (metrics_writer.joinable()) {
+        metrics_writer.request_stop();
+        metrics_writer.join();
+    }
+    metrics::stop_slow_log();
+
+    {
+        std::lock_guard lock(shutdown_mutex);
+        active_server = nullptr;
+    }
 
     std::cout << "Saving database...\n";
-    db::save_to_file(engine, dbfile);
+    if (wal) {
+        wal->checkpoint(engine);
+        engine.set_wal(nullptr);
+    } else {
+        db::save_to_file(engine, dbfile);
+    }
     std::cout << "Server stopped\n";
-}
\ No newline at end of file
+}
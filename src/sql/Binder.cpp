@@ -0,0 +1,287 @@
+#include "sql/Binder.hpp"
+#include "sql/CostModel.hpp"
+#include "sql/QueryArena.hpp"
+#include "db/ValueUtils.hpp"
+#include "sql/parsers/Utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <memory_resource>
+#include <string_view>
+
+namespace sql {
+
+namespace {
+
+// Больше параметров в одном запросе не бывает: номер не раздувает список типов
+constexpr int kMaxParams = 65535;
+
+// index - номер параметра с нуля, -1 для '?'; номер сверх kMaxParams
+// возвращается как kMaxParams, чтобы вызывающий отклонил запрос
+bool is_placeholder(const db::Value& value, int& index) {
+    const auto* s = std::get_if<std::string>(&value);
+    if (!s || s->empty()) return false;
+    if (*s == "?") {
+        index = -1;
+        return true;
+    }
+    if ((*s)[0] != '$' || s->size() < 2) return false;
+    int n = 0;
+    for (size_t i = 1; i < s->size(); ++i) {
+        if (!std::isdigit(static_cast<unsigned char>((*s)[i]))) return false;
+        n = std::min(n * 10 + ((*s)[i] - '0'), kMaxParams + 1);
+    }
+    if (n < 1) return false;
+    index = n - 1;
+    return true;
+}
+
+// Слова условия - срезы текста WHERE, который собран в арене оператора
+void skip_spaces(std::string_view s, size_t& pos) {
+    while (pos < s.size() && std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+}
+
+std::string_view read_word(std::string_view s, size_t& pos) {
+    size_t begin = pos;
+    while (pos < s.size() && !std::isspace(static_cast<unsigned char>(s[pos])) && s[pos] != '=') ++pos;
+    return s.substr(begin, pos - begin);
+}
+
+std::string_view read_value(std::string_view s, size_t& pos) {
+    size_t begin = pos;
+    if (pos < s.size() && s[pos] == '"') {
+        size_t end = s.find('"', pos + 1);
+        pos = end == std::string::npos ? s.size() : end + 1;
+    } else {
+        while (pos < s.size() && !std::isspace(static_cast<unsigned char>(s[pos]))) ++pos;
+    }
+    return s.substr(begin, pos - begin);
+}
+
+}
+
+bool Binder::fail(std::string error) {
+    error_ = std::move(error);
+    return false;
+}
+
+const db::Table* Binder::find_table(const std::string& name) {
+    const auto* table = db_.get_table(name);
+    if (!table) fail("Table not found");
+    return table;
+}
+
+bool Binder::bind(const ParseResult& pr, BoundStatement& out) {
+    switch (pr.type) {
+    case CommandType::SELECT: {
+        BoundSelect plan;
+        if (!bind_select(std::get<Select>(pr.command), plan)) return false;
+        out = std::move(plan);
+        return true;
+    }
+    case CommandType::INSERT: {
+        BoundInsert plan;
+        if (!bind_insert(std::get<Insert>(pr.command), plan)) return false;
+        out = std::move(plan);
+        return true;
+    }
+    case CommandType::UPDATE: {
+        BoundUpdate plan;
+        if (!bind_update(std::get<Update>(pr.command), plan)) return false;
+        out = std::move(plan);
+        return true;
+    }
+    case CommandType::DELETE: {
+        BoundDelete plan;
+        if (!bind_delete(std::get<Delete>(pr.command), plan)) return false;
+        out = std::move(plan);
+        return true;
+    }
+    default:
+        return fail("Only SELECT, INSERT, UPDATE and DELETE can be prepared");
+    }
+}
+
+bool Binder::bind_value(const db::Value& literal, bool quoted, const db::Column& column, ColumnType type, BoundValue& out) {
+    int index = 0;
+    if (allow_params_ && !quoted && is_placeholder(literal, index)) {
+        if (index == -1) index = next_param_;
+        if (index >= kMaxParams) {
+            return fail("Parameter number exceeds the limit of " + std::to_string(kMaxParams));
+        }
+        next_param_ = std::max(next_param_, index + 1);
+        if (param_types_.size() <= static_cast<size_t>(index)) param_types_.resize(index + 1);
+        auto& param_type = param_types_[index];
+        if (param_type && *param_type != type) {
+            return fail("Parameter $" + std::to_string(index + 1) + " is used as both " +
+                        column_type_name(*param_type) + " and " + column_type_name(type));
+        }
+        param_type = type;
+        out.param = index;
+        return true;
+    }
+
+    out.value = literal;
+    if (type == ColumnType::FLOAT && std::holds_alternative<int>(literal)) {
+        out.value = static_cast<float>(std::get<int>(literal));
+    }
+    if (!value_matches_type(out.value, type)) {
+        return fail("Type mismatch for column '" + column.get_name() +
+                    "': expected " + column.get_type() + ", got value '" + db::value_to_string(literal) + "'");
+    }
+    return true;
+}
+
+bool Binder::bind_where(const std::vector<std::string>& tokens, const db::Table& table, BoundWhere& out) {
+    if (tokens.empty()) return true;
+    out.present = true;
+
+    size_t length = 0;
+    for (const auto& token : tokens) length += token.size() + 1;
+    std::pmr::string text(QueryArena::current());
+    text.reserve(length);
+    for (const auto& token : tokens) {
+        if (!text.empty()) text += ' ';
+        text += token;
+    }
+
+    out.any_of.emplace_back();
+    size_t pos = 0;
+    skip_spaces(text, pos);
+    while (pos < text.size()) {
+        std::string_view column_name = read_word(text, pos);
+        skip_spaces(text, pos);
+        if (pos >= text.size() || text[pos] != '=') {
+            return fail("Expected '=' after '" + std::string(column_name) + "' in WHERE clause");
+        }
+        ++pos;
+        skip_spaces(text, pos);
+        std::string_view value_str = read_value(text, pos);
+        if (column_name.empty() || value_str.empty()) {
+            return fail("Invalid condition in WHERE clause");
+        }
+
+        int column_index = table.find_column(column_name);
+        if (column_index == -1) {
+            return fail("Column '" + std::string(column_name) + "' not found in table");
+        }
+
+        const auto& column = table.get_columns()[column_index];
+        const ColumnType type = column_type_from(column.get_type());
+        Predicate predicate{static_cast<size_t>(column_index), {}, select_compare_kernel(type, CompareOp::EQ)};
+        if (!bind_value(parsers::parse_value(value_str), parsers::is_quoted(value_str), column, type, predicate.value)) {
+            return false;
+        }
+        out.any_of.back().push_back(std::move(predicate));
+
+        skip_spaces(text, pos);
+        size_t save = pos;
+        std::string_view connector = read_word(text, pos);
+        if (parsers::equals_upper(connector, "AND")) {
+            skip_spaces(text, pos);
+        } else if (parsers::equals_upper(connector, "OR")) {
+            skip_spaces(text, pos);
+            out.any_of.emplace_back();
+        } else {
+            // Условия без связки, как и раньше, объединяются через OR
+            pos = save;
+            if (pos < text.size()) out.any_of.emplace_back();
+        }
+    }
+
+    if (out.any_of.back().empty()) {
+        return fail("Incomplete WHERE clause");
+    }
+    order_predicates(out, table);
+    return true;
+}
+
+bool Binder::bind_select(const Select& cmd, BoundSelect& out) {
+    const auto* table = find_table(cmd.table_name);
+    if (!table) return false;
+
+    out.table_name = cmd.table_name;
+    const auto& columns = table->get_columns();
+    if (cmd.columns.size() == 1 && cmd.columns[0] == "*") {
+        for (size_t i = 0; i < columns.size(); ++i) out.columns.push_back(i);
+    } else {
+        for (const auto& col_name : cmd.columns) {
+            int index = table->find_column(col_name);
+            if (index == -1) return fail("Column '" + col_name + "' not found in table");
+            out.columns.push_back(static_cast<size_t>(index));
+        }
+    }
+    return bind_where(cmd.where, *table, out.where);
+}
+
+bool Binder::bind_insert(const Insert& cmd, BoundInsert& out) {
+    const auto* table = find_table(cmd.table_name);
+    if (!table) return false;
+    if (cmd.rows.empty()) return fail("No values to insert");
+
+    out.table_name = cmd.table_name;
+    const auto& columns = table->get_columns();
+    if (!cmd.columns.empty()) {
+        for (const auto& col_name : cmd.columns) {
+            int index = table->find_column(col_name);
+            if (index == -1) return fail("Column '" + col_name + "' not found in table");
+            out.target_columns.push_back(static_cast<size_t>(index));
+        }
+    } else {
+        for (size_t i = 0; i < columns.size(); ++i) out.target_columns.push_back(i);
+    }
+
+    // Типы колонок разрешаются один раз, а не для каждого значения
+    std::vector<ColumnType> target_types;
+    target_types.reserve(out.target_columns.size());
+    for (size_t index : out.target_columns) target_types.push_back(column_type_from(columns[index].get_type()));
+
+    out.rows.reserve(cmd.rows.size());
+    for (size_t r = 0; r < cmd.rows.size(); ++r) {
+        const auto& values = cmd.rows[r];
+        if (values.size() != out.target_columns.size()) {
+            return fail(cmd.columns.empty() ? "Value count doesn't match column count"
+                                            : "Column count doesn't match value count");
+        }
+        auto& row = out.rows.emplace_back(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            bool quoted = r < cmd.quoted.size() && i < cmd.quoted[r].size() && cmd.quoted[r][i];
+            if (!bind_value(values[i], quoted, columns[out.target_columns[i]], target_types[i], row[i])) return false;
+        }
+    }
+    return true;
+}
+
+bool Binder::bind_update(const Update& cmd, BoundUpdate& out) {
+    const auto* table = find_table(cmd.table_name);
+    if (!table) return false;
+
+    out.table_name = cmd.table_name;
+    for (const auto& set_clause : cmd.set) {
+        size_t equals_pos = set_clause.find('=');
+        if (equals_pos == std::string::npos) return fail("Invalid SET clause: " + set_clause);
+
+        std::string_view column_name = std::string_view(set_clause).substr(0, equals_pos);
+        int column_index = table->find_column(column_name);
+        if (column_index == -1) return fail("Column '" + std::string(column_name) + "' not found in table");
+
+        std::string_view value_str = std::string_view(set_clause).substr(equals_pos + 1);
+        const auto& column = table->get_columns()[column_index];
+        BoundValue value;
+        if (!bind_value(parsers::parse_value(value_str), parsers::is_quoted(value_str), column,
+                        column_type_from(column.get_type()), value)) {
+            return false;
+        }
+        out.set.emplace_back(static_cast<size_t>(column_index), std::move(value));
+    }
+    return bind_where(cmd.where, *table, out.where);
+}
+
+bool Binder::bind_delete(const Delete& cmd, BoundDelete& out) {
+    const auto* table = find_table(cmd.table_name);
+    if (!table) return false;
+
+    out.table_name = cmd.table_name;
+    return bind_where(cmd.where, *table, out.where);
+}
+
+}
@@ -0,0 +1,101 @@
+#include "sql/CostModel.hpp"
+#include "db/ValueUtils.hpp"
+#include <algorithm>
+
+namespace sql {
+
+namespace {
+constexpr double kDefaultEqualitySelectivity = 0.005;
+
+// Относительная стоимость одного сравнения по типу колонки
+double compare_cost(const db::Column& column) noexcept {
+    switch (column_type_from(column.get_type())) {
+    case ColumnType::STR: return 2.5;
+    case ColumnType::UNKNOWN: return 3;
+    default: return 1;
+    }
+}
+
+const db::ColumnStatistics* column_statistics(const db::TableStatistics* statistics, size_t column) noexcept {
+    if (!statistics || column >= statistics->columns.size()) return nullptr;
+    return &statistics->columns[column];
+}
+}
+
+double estimate_selectivity(const Predicate& predicate, const db::TableStatistics* statistics) noexcept {
+    const auto* stats = column_statistics(statistics, predicate.column);
+    if (!stats || statistics->row_count == 0) return kDefaultEqualitySelectivity;
+
+    const double min_selectivity = 1.0 / static_cast<double>(statistics->row_count + 1);
+    const double non_null = 1 - stats->null_fraction;
+    // Значение параметра неизвестно до EXECUTE
+    if (predicate.value.param != -1) return std::max(min_selectivity, non_null / std::max(stats->distinct, 1.0));
+
+    const auto& value = predicate.value.value;
+    if (std::holds_alternative<db::NullValue>(value)) return std::max(min_selectivity, stats->null_fraction);
+
+    const auto& bounds = stats->histogram;
+    if (bounds.empty()) return min_selectivity;
+    if (db::value_less(value, bounds.front()) || db::value_less(bounds.back(), value)) return min_selectivity;
+
+    // Частое значение занимает несколько соседних границ гистограммы
+    const auto [first, last] = std::equal_range(bounds.begin(), bounds.end(), value,
+                                                [](const db::Value& a, const db::Value& b) { return db::value_less(a, b); });
+    const auto repeats = static_cast<double>(last - first);
+    const double buckets = static_cast<double>(std::max<size_t>(bounds.size() - 1, 1));
+    const double frequent = repeats >= 2 ? (repeats - 1) / buckets : 0;
+    return std::max(min_selectivity, non_null * std::max(frequent, 1.0 / std::max(stats->distinct, 1.0)));
+}
+
+double estimate_selectivity(const BoundWhere& where, const db::TableStatistics* statistics) noexcept {
+    if (!where.present) return 1;
+    // Условия считаются независимыми
+    double none = 1;
+    for (const auto& group : where.any_of) {
+        double all = 1;
+        for (const auto& predicate : group) all *= estimate_selectivity(predicate, statistics);
+        none *= 1 - all;
+    }
+    return 1 - none;
+}
+
+double estimate_rows(const BoundWhere& where, const db::Table& table) {
+    const auto statistics = table.get_statistics();
+    // Счетчики читаются по отдельности и могут разойтись с параллельной сборкой мусора
+    const size_t total = table.get_version_count();
+    const size_t dead = table.get_dead_version_count();
+    const double rows = statistics ? static_cast<double>(statistics->row_count)
+                                   : static_cast<double>(total > dead ? total - dead : 0);
+    return rows * estimate_selectivity(where, statistics.get());
+}
+
+void order_predicates(BoundWhere& where, const db::Table& table) {
+    if (!where.present) return;
+    const auto statistics = table.get_statistics();
+    const auto& columns = table.get_columns();
+
+    std::vector<std::pair<double, std::vector<Predicate>>> groups;
+    for (auto& group : where.any_of) {
+        std::vector<std::pair<double, Predicate>> ranked;
+        double all = 1;
+        for (auto& predicate : group) {
+            const double selectivity = estimate_selectivity(predicate, statistics.get());
+            all *= selectivity;
+            // Стоимость сравнения на каждую отброшенную им строку
+            const double rank = compare_cost(columns[predicate.column]) / std::max(1 - selectivity, 1e-9);
+            ranked.emplace_back(rank, std::move(predicate));
+        }
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        std::vector<Predicate> ordered;
+        for (auto& [rank, predicate] : ranked) ordered.push_back(std::move(predicate));
+        groups.emplace_back(all, std::move(ordered));
+    }
+    std::stable_sort(groups.begin(), groups.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    where.any_of.clear();
+    for (auto& [selectivity, group] : groups) where.any_of.push_back(std::move(group));
+    where.selectivity = estimate_selectivity(where, statistics.get());
+}
+
+}
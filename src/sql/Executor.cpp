@@ -1,4 +1,6 @@
 #include "sql/Executor.hpp"
+#include "sql/StatementLocks.hpp"
+#include "sql/QueryArena.hpp"
 #include "sql/executors/CreateExecutor.hpp"
 #include "sql/executors/DropExecutor.hpp"
 #include "sql/executors/UseExecutor.hpp"
@@ -6,6 +8,14 @@
 #include "sql/executors/SelectExecutor.hpp"
 #include "sql/executors/UpdateExecutor.hpp"
 #include "sql/executors/DeleteExecutor.hpp"
+#include "sql/executors/CopyExecutor.hpp"
+#include "sql/executors/PrepareExecutor.hpp"
+#include "sql/executors/TransactionExecutor.hpp"
+#include "sql/executors/ShowExecutor.hpp"
+#include "sql/executors/ExplainExecutor.hpp"
+#include "sql/executors/AnalyzeExecutor.hpp"
+#include "db/WriteAheadLog.hpp"
+#include <optional>
 #include <variant>
 #include <algorithm>
 #include <iostream>
@@ -13,51 +23,155 @@
 
 using namespace sql;
 
-std::string Executor::current_db = "";
+namespace {
+ExecResult dispatch(const ParseResult& pr, db::StorageEngine& engine, Session& session, const db::StatementVersion& version,
+                    bool defer_durability) {
+    auto& current_db = session.current_db;
+    auto& prepared = session.prepared;
+    switch (pr.type) {
+    case CommandType::CREATE_DATABASE: {
+        const auto& cmd = std::get<CreateDatabase>(pr.command);
+        return executors::execute_create_database(cmd, engine);
+    }
+    case CommandType::DROP_DATABASE: {
+        const auto& cmd = std::get<DropDatabase>(pr.command);
+        return executors::execute_drop_database(cmd, engine, current_db);
+    }
+    case CommandType::USE: {
+        const auto& cmd = std::get<Use>(pr.command);
+        return executors::execute_use(cmd, engine, current_db);
+    }
+    case CommandType::CREATE_TABLE: {
+        const auto& cmd = std::get<CreateTable>(pr.command);
+        return executors::execute_create_table(cmd, engine, current_db);
+    }
+    case CommandType::DROP_TABLE: {
+        const auto& cmd = std::get<DropTable>(pr.command);
+        return executors::execute_drop_table(cmd, engine, current_db);
+    }
+    case CommandType::INSERT: {
+        const auto& cmd = std::get<Insert>(pr.command);
+        return executors::execute_insert(cmd, engine, current_db, version);
+    }
+    case CommandType::SELECT: {
+        const auto& cmd = std::get<Select>(pr.command);
+        return executors::execute_select(cmd, engine, current_db, version);
+    }
+    case CommandType::UPDATE: {
+        const auto& cmd = std::get<Update>(pr.command);
+        return executors::execute_update(cmd, engine, current_db, version);
+    }
+    case CommandType::DELETE: {
+        const auto& cmd = std::get<Delete>(pr.command);
+        return executors::execute_delete(cmd, engine, current_db, version);
+    }
+    case CommandType::COPY: {
+        const auto& cmd = std::get<Copy>(pr.command);
+        return executors::execute_copy(cmd, engine, current_db, version);
+    }
+    case CommandType::PREPARE: {
+        const auto& cmd = std::get<Prepare>(pr.command);
+        return executors::execute_prepare(cmd, engine, current_db, prepared);
+    }
+    case CommandType::EXECUTE: {
+        const auto& cmd = std::get<Execute>(pr.command);
+        return executors::execute_execute(cmd, engine, current_db, prepared, version);
+    }
+    case CommandType::DEALLOCATE: {
+        const auto& cmd = std::get<Deallocate>(pr.command);
+        return executors::execute_deallocate(cmd, prepared);
+    }
+    case CommandType::BEGIN:
+        return executors::execute_begin(engine, session.transaction);
+    case CommandType::COMMIT:
+        return executors::execute_commit(engine, session.transaction, defer_durability);
+    case CommandType::ROLLBACK:
+        return executors::execute_rollback(session.transaction);
+    case CommandType::SHOW: {
+        const auto& cmd = std::get<Show>(pr.command);
+        return executors::execute_show(cmd, engine, session);
+    }
+    case CommandType::EXPLAIN: {
+        const auto& cmd = std::get<Explain>(pr.command);
+        return executors::execute_explain(cmd, engine, session);
+    }
+    case CommandType::ANALYZE: {
+        const auto& cmd = std::get<Analyze>(pr.command);
+        return executors::execute_analyze(cmd, engine, current_db);
+    }
+    default:
+        return {false, "Unsupported command", ""};
+    }
+}
 
-ExecResult Executor::execute(const ParseResult& pr, db::StorageEngine& engine) {
-    try {
-        switch (pr.type) {
-        case CommandType::CREATE_DATABASE: {
-            const auto& cmd = std::get<CreateDatabase>(pr.command);
-            return executors::execute_create_database(cmd, engine);
-        }
-        case CommandType::DROP_DATABASE: {
-            const auto& cmd = std::get<DropDatabase>(pr.command);
-            return executors::execute_drop_database(cmd, engine, current_db);
-        }
-        case CommandType::USE: {
-            const auto& cmd = std::get<Use>(pr.command);
-            return executors::execute_use(cmd, engine, current_db);
-        }
-        case CommandType::CREATE_TABLE: {
-            const auto& cmd = std::get<CreateTable>(pr.command);
-            return executors::execute_create_table(cmd, engine, current_db);
-        }
-        case CommandType::DROP_TABLE: {
-            const auto& cmd = std::get<DropTable>(pr.command);
-            return executors::execute_drop_table(cmd, engine, current_db);
-        }
-        case CommandType::INSERT: {
-            const auto& cmd = std::get<Insert>(pr.command);
-            return executors::execute_insert(cmd, engine, current_db);
-        }
-        case CommandType::SELECT: {
-            const auto& cmd = std::get<Select>(pr.command);
-            return executors::execute_select(cmd, engine, current_db);
-        }
-        case CommandType::UPDATE: {
-            const auto& cmd = std::get<Update>(pr.command);
-            return executors::execute_update(cmd, engine, current_db);
+// Команды, которые не читают таблицы и выполняются без блокировок и снимка.
+// EXPLAIN берет нужные блокировки сам или выполняет оператор через execute
+bool is_lock_free(CommandType type) {
+    return type == CommandType::BEGIN || type == CommandType::COMMIT || type == CommandType::ROLLBACK ||
+           type == CommandType::SHOW || type == CommandType::EXPLAIN;
+}
+}
+
+ExecResult Executor::execute(const ParseResult& pr, db::StorageEngine& engine, Session& session,
+                             bool defer_durability) {
+    QueryArena arena;
+    if (is_lock_free(pr.type)) {
+        try {
+            return dispatch(pr, engine, session, {}, defer_durability);
+        } catch (const std::exception& e) {
+            return {false, e.what(), ""};
         }
-        case CommandType::DELETE: {
-            const auto& cmd = std::get<Delete>(pr.command);
-            return executors::execute_delete(cmd, engine, current_db);
+    }
+    if (session.transaction && is_schema_change(pr.type)) {
+        return {false, "CREATE and DROP are not allowed inside a transaction", ""};
+    }
+
+    // Вне явной транзакции каждый изменяющий оператор выполняется в своей
+    std::optional<db::Transaction> implicit;
+    db::Transaction* transaction = session.transaction.get();
+    if (!transaction && is_write(resolve_statement(pr, session))) {
+        implicit.emplace(engine.get_versions());
+        transaction = &*implicit;
+    }
+
+    StatementLocks locks(pr, engine, session, transaction);
+    if (!locks.is_acquired()) {
+        if (!session.transaction) return {false, "Lock wait timeout exceeded", ""};
+        session.transaction.reset();
+        return {false, "Lock wait timeout exceeded, transaction rolled back", ""};
+    }
+
+    db::Snapshot snapshot(engine.get_versions());
+    const size_t savepoint = transaction ? transaction->get_savepoint() : 0;
+
+    ExecResult result;
+    try {
+        result = dispatch(pr, engine, session, {snapshot.get(), transaction}, defer_durability);
+    } catch (const std::exception& e) {
+        result = {false, e.what(), ""};
+    }
+
+    // Неудачный оператор не оставляет частичных изменений
+    if (!result.ok) {
+        if (transaction) transaction->rollback_to(savepoint);
+        return result;
+    }
+
+    if (implicit) {
+        std::string error;
+        if (!implicit->commit(engine.get_wal(), error, defer_durability ? &result.pending_commit : nullptr)) {
+            return {false, error, ""};
         }
-        default:
-            return {false, "Unsupported command", ""};
+    }
+
+    if (is_schema_change(pr.type)) {
+        engine.bump_schema_version();
+        // Схема не пишется в журнал: после CREATE/DROP сохраняется новый снимок.
+        // Изменение уже видно, поэтому клиенту сообщается, что оно может не сохраниться
+        if (auto* wal = engine.get_wal(); wal && !wal->checkpoint(engine)) {
+            return {false, "Checkpoint after schema change failed: the change is visible but may be lost "
+                           "on restart; further commits are rejected", ""};
         }
-    } catch (const std::exception& e) {
-        return {false, e.what(), ""};
     }
+    return result;
 }
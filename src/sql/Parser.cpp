@@ -6,6 +6,12 @@
 #include "sql/parsers/UpdateParser.hpp"
 #include "sql/parsers/UseParser.hpp"
 #include "sql/parsers/DeleteParser.hpp"
+#include "sql/parsers/CopyParser.hpp"
+#include "sql/parsers/PrepareParser.hpp"
+#include "sql/parsers/TransactionParser.hpp"
+#include "sql/parsers/ShowParser.hpp"
+#include "sql/parsers/ExplainParser.hpp"
+#include "sql/parsers/AnalyzeParser.hpp"
 #include "sql/parsers/OtherParsers.hpp"
 #include "sql/parsers/Utils.hpp"
 #include <algorithm>
@@ -92,5 +98,45 @@ ParseResult Parser::parse(const std::string& query) {
         return parsers::parse_use(iss);
     }
     
+    if (word == "COPY") {
+        return parsers::parse_copy(iss);
+    }
+    
+    if (word == "PREPARE") {
+        return parsers::parse_prepare(iss);
+    }
+    
+    if (word == "EXECUTE") {
+        return parsers::parse_execute(iss);
+    }
+    
+    if (word == "DEALLOCATE") {
+        return parsers::parse_deallocate(iss);
+    }
+    
+    if (word == "BEGIN" || word == "BEGIN;") {
+        return parsers::parse_begin(iss);
+    }
+    
+    if (word == "COMMIT" || word == "COMMIT;") {
+        return parsers::parse_commit(iss);
+    }
+    
+    if (word == "ROLLBACK" || word == "ROLLBACK;") {
+        return parsers::parse_rollback(iss);
+    }
+    
+    if (word == "SHOW") {
+        return parsers::parse_show(iss);
+    }
+    
+    if (word == "EXPLAIN") {
+        return parsers::parse_explain(iss);
+    }
+    
+    if (word == "ANALYZE" || word == "ANALYZE;") {
+        return parsers::parse_analyze(iss);
+    }
+    
     return {CommandType::UNKNOWN, {}, false, "Unknown or unsupported command"};
 }
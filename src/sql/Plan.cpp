@@ -0,0 +1,23 @@
+#include "sql/Plan.hpp"
+
+namespace sql {
+
+bool matches(const BoundWhere& where, const db::Row& row, const std::vector<db::Value>& params) {
+    if (!where.present) return true;
+
+    const auto& values = row.get_values();
+    for (const auto& group : where.any_of) {
+        bool all = true;
+        for (const auto& predicate : group) {
+            if (predicate.column >= values.size() ||
+                !predicate.compare(values[predicate.column], predicate.value.resolve(params))) {
+                all = false;
+                break;
+            }
+        }
+        if (all) return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,47 @@
+#include "sql/Profiler.hpp"
+#include "sql/QueryArena.hpp"
+
+namespace sql {
+
+namespace {
+thread_local Profiler* active_profiler = nullptr;
+}
+
+Profiler::Profiler() : previous_(active_profiler) {
+    active_profiler = this;
+}
+
+Profiler::~Profiler() {
+    active_profiler = previous_;
+}
+
+Profiler* Profiler::current() noexcept {
+    return active_profiler;
+}
+
+OperatorScope::OperatorScope(std::string_view name, std::string_view detail) : profiler_(active_profiler) {
+    if (!profiler_) return;
+    // Стадия занимает место в порядке начала, даже если вложенная закончится раньше
+    index_ = profiler_->operators_.size();
+    profiler_->operators_.push_back({std::string(name), std::string(detail)});
+    bytes_at_start_ = QueryArena::allocated_bytes();
+    started_ = std::chrono::steady_clock::now();
+}
+
+OperatorScope::~OperatorScope() {
+    finish();
+}
+
+void OperatorScope::finish() noexcept {
+    if (!profiler_) return;
+    auto& stats = profiler_->operators_[index_];
+    stats.elapsed = std::chrono::steady_clock::now() - started_;
+    stats.bytes_allocated = QueryArena::allocated_bytes() - bytes_at_start_;
+    stats.rows_in = rows_in_;
+    stats.rows_out = rows_out_;
+    stats.blocks = blocks_;
+    stats.blocks_skipped = blocks_skipped_;
+    profiler_ = nullptr;
+}
+
+}
@@ -0,0 +1,39 @@
+#include "sql/QueryArena.hpp"
+
+namespace sql {
+
+namespace {
+thread_local QueryArena* active_arena = nullptr;
+// Начальный блок переиспользуется операторами одного потока
+alignas(std::max_align_t) thread_local std::byte initial_block[QueryArena::kInitialSize];
+}
+
+QueryArena::QueryArena() : previous_(active_arena) {
+    // Вложенная арена не может делить начальный блок с внешней
+    if (previous_) {
+        resource_.emplace(kInitialSize);
+    } else {
+        resource_.emplace(initial_block, kInitialSize);
+    }
+    active_arena = this;
+}
+
+QueryArena::~QueryArena() {
+    active_arena = previous_;
+}
+
+void* QueryArena::do_allocate(size_t bytes, size_t alignment) {
+    allocated_ += bytes;
+    return resource_->allocate(bytes, alignment);
+}
+
+std::pmr::memory_resource* QueryArena::current() noexcept {
+    if (active_arena) return active_arena;
+    return std::pmr::get_default_resource();
+}
+
+uint64_t QueryArena::allocated_bytes() noexcept {
+    return active_arena ? active_arena->allocated_ : 0;
+}
+
+}
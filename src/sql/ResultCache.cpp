@@ -0,0 +1,188 @@
+#include "sql/ResultCache.hpp"
+#include "sql/StatementLocks.hpp"
+#include "db/ValueUtils.hpp"
+#include <atomic>
+#include <cctype>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace sql {
+
+namespace {
+// Служебные данные записи сверх ключа и ответа
+constexpr size_t kEntryOverhead = 128;
+// Один ответ занимает не больше этой доли кэша
+constexpr size_t kMaxEntryShare = 4;
+
+struct Entry {
+    std::string key;
+    uint64_t schema_version;
+    db::Version snapshot;
+    std::string body;
+
+    [[nodiscard]] size_t size() const noexcept {
+        return key.size() + body.size() + kEntryOverhead;
+    }
+};
+
+// Начало списка - недавно использованные записи
+struct CacheState {
+    std::mutex mutex;
+    std::list<Entry> entries;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+    size_t capacity = 0;
+    size_t bytes = 0;
+    uint64_t evictions = 0;
+};
+
+CacheState& state() {
+    static CacheState cache;
+    return cache;
+}
+
+std::atomic<bool> enabled_{false};
+std::atomic<uint64_t> hits_{0};
+std::atomic<uint64_t> misses_{0};
+
+void erase(CacheState& cache, std::list<Entry>::iterator it) {
+    cache.bytes -= it->size();
+    cache.index.erase(it->key);
+    cache.entries.erase(it);
+}
+
+void append_param(std::string& key, const db::Value& value) {
+    const std::string text = db::value_to_string(value);
+    key += '\n';
+    key += std::to_string(value.index());
+    key += ':';
+    key += std::to_string(text.size());
+    key += ':';
+    key += text;
+}
+}
+
+std::string normalize_statement(std::string_view query) {
+    std::string out;
+    out.reserve(query.size());
+    bool in_string = false;
+    bool pending_space = false;
+    for (char c : query) {
+        if (!in_string && std::isspace(static_cast<unsigned char>(c))) {
+            pending_space = !out.empty();
+            continue;
+        }
+        if (pending_space) {
+            out += ' ';
+            pending_space = false;
+        }
+        // Строковые литералы движка - в двойных кавычках, как в parse_value_tuple
+        if (c == '"') in_string = !in_string;
+        out += c;
+    }
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) out.pop_back();
+    return out;
+}
+
+std::optional<CachedQuery> cached_query(const ParseResult& pr, const Session& session,
+                                        std::string_view query, bool binary) {
+    if (!ResultCache::enabled() || session.transaction || session.current_db.empty()) return std::nullopt;
+
+    const ParseResult& statement = resolve_statement(pr, session);
+    if (statement.type != CommandType::SELECT) return std::nullopt;
+
+    CachedQuery cached{binary ? "B" : "T", session.current_db, std::get<Select>(statement.command).table_name};
+    if (pr.type == CommandType::EXECUTE) {
+        const auto& cmd = std::get<Execute>(pr.command);
+        cached.key += normalize_statement(session.prepared.at(cmd.name).query);
+        for (const auto& param : cmd.params) append_param(cached.key, param);
+    } else {
+        if (query.empty()) return std::nullopt;
+        cached.key += normalize_statement(query);
+    }
+    cached.key = session.current_db + '\0' + cached.key;
+    return cached;
+}
+
+void ResultCache::set_capacity(size_t bytes) {
+    auto& cache = state();
+    std::lock_guard lock(cache.mutex);
+    cache.capacity = bytes;
+    while (cache.bytes > cache.capacity && !cache.entries.empty()) {
+        erase(cache, std::prev(cache.entries.end()));
+        ++cache.evictions;
+    }
+    enabled_.store(bytes > 0, std::memory_order_relaxed);
+}
+
+bool ResultCache::enabled() noexcept {
+    return enabled_.load(std::memory_order_relaxed);
+}
+
+std::optional<std::string> ResultCache::lookup(const CachedQuery& query, const db::StorageEngine& engine,
+                                               Ticket& ticket) {
+    ticket = {};
+    // Кэш не ждет DDL: занятый каталог означает обычное выполнение
+    auto& catalog = engine.get_catalog_lock();
+    if (!catalog.try_lock_shared_until(db::RwLock::Clock::now())) return std::nullopt;
+
+    db::Version last_commit = db::kMaxVersion;
+    if (const auto* db = engine.get_database(query.database)) {
+        if (const auto* table = db->get_table(query.table)) last_commit = table->get_last_commit();
+    }
+    const uint64_t schema_version = engine.get_schema_version();
+    {
+        // Нижняя граница снимка, который возьмет выполнение оператора
+        db::Snapshot snapshot(engine.get_versions());
+        ticket = {last_commit != db::kMaxVersion, schema_version, snapshot.get()};
+    }
+    catalog.unlock_shared();
+
+    auto& cache = state();
+    std::lock_guard lock(cache.mutex);
+    auto found = cache.index.find(query.key);
+    if (found == cache.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    auto it = found->second;
+    if (it->schema_version != schema_version || last_commit > it->snapshot) {
+        erase(cache, it);
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    cache.entries.splice(cache.entries.begin(), cache.entries, it);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->body;
+}
+
+void ResultCache::store(const CachedQuery& query, const Ticket& ticket, const std::string& body) {
+    if (!ticket.valid) return;
+
+    Entry entry{query.key, ticket.schema_version, ticket.snapshot, body};
+    auto& cache = state();
+    std::lock_guard lock(cache.mutex);
+    if (entry.size() > cache.capacity / kMaxEntryShare) return;
+
+    if (auto found = cache.index.find(query.key); found != cache.index.end()) {
+        // Параллельный запрос мог сохранить результат по более новому снимку
+        if (found->second->snapshot >= entry.snapshot) return;
+        erase(cache, found->second);
+    }
+    cache.bytes += entry.size();
+    cache.entries.push_front(std::move(entry));
+    cache.index.emplace(cache.entries.front().key, cache.entries.begin());
+    while (cache.bytes > cache.capacity) {
+        erase(cache, std::prev(cache.entries.end()));
+        ++cache.evictions;
+    }
+}
+
+ResultCacheStats ResultCache::stats() {
+    auto& cache = state();
+    std::lock_guard lock(cache.mutex);
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed), cache.evictions,
+            cache.entries.size(), cache.bytes};
+}
+
+}
@@ -0,0 +1,246 @@
+#include "sql/ResultSet.hpp"
+#include "db/ValueUtils.hpp"
+#include <bit>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace sql {
+
+namespace {
+
+template <typename T>
+void append_le(std::string& out, T value) {
+    static_assert(std::is_integral_v<T>);
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<char>((static_cast<uint64_t>(value) >> (8 * i)) & 0xFF));
+    }
+}
+
+template <typename T>
+void append_array_le(std::string& out, const T* data, size_t count) {
+    if constexpr (std::endian::native == std::endian::little) {
+        out.append(reinterpret_cast<const char*>(data), count * sizeof(T));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            if constexpr (std::is_same_v<T, float>) {
+                append_le(out, std::bit_cast<uint32_t>(data[i]));
+            } else {
+                append_le(out, data[i]);
+            }
+        }
+    }
+}
+
+ResultType result_type_from(const std::string& type) {
+    if (type == "INT") return ResultType::INT;
+    if (type == "FLOAT") return ResultType::FLOAT;
+    if (type == "BOOL") return ResultType::BOOL;
+    return ResultType::STR;
+}
+
+}
+
+void ResultColumn::reserve(size_t rows) {
+    null_bitmap.reserve((rows + 7) / 8);
+    switch (type) {
+    case ResultType::INT: ints.reserve(rows); break;
+    case ResultType::FLOAT: floats.reserve(rows); break;
+    case ResultType::BOOL: bools.reserve(rows); break;
+    case ResultType::STR: offsets.reserve(rows + 1); break;
+    }
+}
+
+void ResultColumn::append(const db::Value& value) {
+    if (size % 8 == 0) null_bitmap.push_back(0);
+
+    bool is_null = false;
+    switch (type) {
+    case ResultType::INT: {
+        const int* v = std::get_if<int>(&value);
+        is_null = !v;
+        ints.push_back(v ? *v : 0);
+        break;
+    }
+    case ResultType::FLOAT: {
+        const float* v = std::get_if<float>(&value);
+        is_null = !v;
+        floats.push_back(v ? *v : 0.0f);
+        break;
+    }
+    case ResultType::BOOL: {
+        const bool* v = std::get_if<bool>(&value);
+        is_null = !v;
+        bools.push_back(v && *v ? 1 : 0);
+        break;
+    }
+    case ResultType::STR: {
+        const std::string* v = std::get_if<std::string>(&value);
+        is_null = !v;
+        // Смещения 32-битные
+        if (v && v->size() > std::numeric_limits<uint32_t>::max() - chars.size()) {
+            throw std::length_error("Result strings exceed 4 GiB");
+        }
+        if (v) chars += *v;
+        offsets.push_back(static_cast<uint32_t>(chars.size()));
+        break;
+    }
+    }
+
+    if (is_null) null_bitmap.back() |= static_cast<uint8_t>(1u << (size % 8));
+    ++size;
+}
+
+bool ResultColumn::is_null(size_t row) const noexcept {
+    return (null_bitmap[row / 8] >> (row % 8)) & 1;
+}
+
+void ResultColumn::append_cell(std::string& out, size_t row) const {
+    if (is_null(row)) {
+        out += "NULL";
+        return;
+    }
+    switch (type) {
+    case ResultType::INT: {
+        char buffer[16];
+        auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), ints[row]);
+        out.append(buffer, end);
+        break;
+    }
+    case ResultType::FLOAT: {
+        // Тот же формат, что у std::to_string
+        char buffer[64];
+        int length = std::snprintf(buffer, sizeof(buffer), "%f", static_cast<double>(floats[row]));
+        out.append(buffer, static_cast<size_t>(length));
+        break;
+    }
+    case ResultType::BOOL: out += bools[row] ? "true" : "false"; break;
+    case ResultType::STR: out.append(chars, offsets[row], offsets[row + 1] - offsets[row]); break;
+    }
+}
+
+void ResultSet::add_column(std::string name, const std::string& type) {
+    ResultColumn column;
+    column.name = std::move(name);
+    column.type = result_type_from(type);
+    columns_.push_back(std::move(column));
+}
+
+void ResultSet::reserve(size_t rows) {
+    for (auto& column : columns_) column.reserve(rows);
+}
+
+std::string ResultSet::to_text() const {
+    const size_t rows = row_count();
+
+    // Оценка размера, чтобы строка результата не перевыделялась при росте
+    size_t estimate = 0;
+    for (const auto& column : columns_) {
+        estimate += 2 * column.name.size() + 6;
+        estimate += column.type == ResultType::STR ? column.chars.size() + 3 * rows : 12 * rows;
+    }
+    std::string result;
+    result.reserve(estimate);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (i > 0) result += " | ";
+        result += columns_[i].name;
+    }
+    result += "\n";
+
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        if (i > 0) result += "-+-";
+        result.append(columns_[i].name.length(), '-');
+    }
+    result += "\n";
+
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = 0; i < columns_.size(); ++i) {
+            if (i > 0) result += " | ";
+            columns_[i].append_cell(result, r);
+        }
+        result += "\n";
+    }
+    return result;
+}
+
+// Формат: заголовок - u16 число колонок; для каждой колонки u8 тип, u16 длина
+// имени, имя. Далее пакеты: u32 число строк, затем по каждой колонке битовая
+// карта NULL и значения (INT/FLOAT - 4 байта, BOOL - 1 байт, STR - n+1 смещений
+// u32 от начала строк пакета и байты строк). Пакет с нулем строк завершает
+// результат. Все числа little-endian.
+bool ResultSet::serialize_binary(size_t max_payload, const std::function<bool(std::string_view)>& emit) const {
+    std::string out;
+    append_le(out, static_cast<uint16_t>(columns_.size()));
+    for (const auto& column : columns_) {
+        out.push_back(static_cast<char>(column.type));
+        append_le(out, static_cast<uint16_t>(column.name.size()));
+        out += column.name;
+    }
+    if (!emit(out)) return false;
+
+    // Размер пакета без битовых карт: число строк и конечные смещения STR
+    size_t row_bytes = 0;
+    size_t batch_bytes = sizeof(uint32_t);
+    for (const auto& column : columns_) {
+        row_bytes += column.type == ResultType::BOOL ? 1 : sizeof(uint32_t);
+        if (column.type == ResultType::STR) batch_bytes += sizeof(uint32_t);
+    }
+
+    const size_t rows = row_count();
+    for (size_t start = 0; start < rows;) {
+        size_t count = 0;
+        size_t bytes = batch_bytes;
+        while (start + count < rows && count < kBatchRows) {
+            size_t next = row_bytes + (count % 8 == 0 ? columns_.size() : 0);
+            for (const auto& column : columns_) {
+                if (column.type == ResultType::STR) {
+                    next += column.offsets[start + count + 1] - column.offsets[start + count];
+                }
+            }
+            if (bytes + next > max_payload) break;
+            bytes += next;
+            ++count;
+        }
+        if (count == 0) return false;
+
+        out.clear();
+        append_le(out, static_cast<uint32_t>(count));
+        for (const auto& column : columns_) {
+            if (start % 8 == 0) {
+                out.append(reinterpret_cast<const char*>(column.null_bitmap.data()) + start / 8, (count + 7) / 8);
+                // Биты строк следующего пакета в последнем байте обнуляются
+                if (count % 8 != 0) out.back() = static_cast<char>(out.back() & ((1u << (count % 8)) - 1));
+            } else {
+                // Пакет начинается не с границы байта: карта собирается заново
+                for (size_t i = 0; i < count; i += 8) {
+                    uint8_t bits = 0;
+                    for (size_t j = i; j < std::min(i + 8, count); ++j) {
+                        if (column.is_null(start + j)) bits |= static_cast<uint8_t>(1u << (j - i));
+                    }
+                    out.push_back(static_cast<char>(bits));
+                }
+            }
+            switch (column.type) {
+            case ResultType::INT: append_array_le(out, column.ints.data() + start, count); break;
+            case ResultType::FLOAT: append_array_le(out, column.floats.data() + start, count); break;
+            case ResultType::BOOL: out.append(reinterpret_cast<const char*>(column.bools.data()) + start, count); break;
+            case ResultType::STR: {
+                const uint32_t begin = column.offsets[start];
+                for (size_t i = 0; i <= count; ++i) append_le(out, column.offsets[start + i] - begin);
+                out.append(column.chars, begin, column.offsets[start + count] - begin);
+                break;
+            }
+            }
+        }
+        if (!emit(out)) return false;
+        start += count;
+    }
+
+    out.clear();
+    append_le(out, static_cast<uint32_t>(0));
+    return emit(out);
+}
+
+}
@@ -0,0 +1,83 @@
+#include "sql/ScanKernels.hpp"
+#include "db/ValueUtils.hpp"
+#include <type_traits>
+#include <variant>
+
+namespace sql {
+
+namespace {
+
+template <typename T, CompareOp Op>
+bool compare_typed(const db::Value& cell, const db::Value& operand) noexcept {
+    const T* a = std::get_if<T>(&cell);
+    const T* b = std::get_if<T>(&operand);
+    if (a && b) [[likely]] {
+        if constexpr (Op == CompareOp::EQ) {
+            return *a == *b;
+        } else {
+            return *a < *b;
+        }
+    }
+    // NULL равен только NULL и не участвует в сравнении на порядок
+    if constexpr (Op == CompareOp::EQ) {
+        return std::holds_alternative<db::NullValue>(cell) && std::holds_alternative<db::NullValue>(operand);
+    } else {
+        return false;
+    }
+}
+
+// Для колонок неизвестного типа остается общее сравнение
+template <CompareOp Op>
+bool compare_generic(const db::Value& cell, const db::Value& operand) noexcept {
+    if constexpr (Op == CompareOp::EQ) {
+        return db::value_equals(cell, operand);
+    } else {
+        return db::value_less(cell, operand);
+    }
+}
+
+// Индексы: [ColumnType][CompareOp]
+constexpr CompareKernel kCompareKernels[][2] = {
+    {compare_typed<int, CompareOp::EQ>, compare_typed<int, CompareOp::LT>},
+    {compare_typed<float, CompareOp::EQ>, compare_typed<float, CompareOp::LT>},
+    {compare_typed<std::string, CompareOp::EQ>, compare_typed<std::string, CompareOp::LT>},
+    {compare_typed<bool, CompareOp::EQ>, compare_typed<bool, CompareOp::LT>},
+    {compare_generic<CompareOp::EQ>, compare_generic<CompareOp::LT>},
+};
+
+}
+
+ColumnType column_type_from(const std::string& type) noexcept {
+    if (type == "INT") return ColumnType::INT;
+    if (type == "FLOAT") return ColumnType::FLOAT;
+    if (type == "STR") return ColumnType::STR;
+    if (type == "BOOL") return ColumnType::BOOL;
+    return ColumnType::UNKNOWN;
+}
+
+const char* column_type_name(ColumnType type) noexcept {
+    switch (type) {
+    case ColumnType::INT: return "INT";
+    case ColumnType::FLOAT: return "FLOAT";
+    case ColumnType::STR: return "STR";
+    case ColumnType::BOOL: return "BOOL";
+    default: return "UNKNOWN";
+    }
+}
+
+// Порядок ColumnType совпадает с порядком альтернатив db::Value
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(ColumnType::INT), db::Value>, int>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(ColumnType::FLOAT), db::Value>, float>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(ColumnType::STR), db::Value>, std::string>);
+static_assert(std::is_same_v<std::variant_alternative_t<static_cast<size_t>(ColumnType::BOOL), db::Value>, bool>);
+
+bool value_matches_type(const db::Value& value, ColumnType type) noexcept {
+    return std::holds_alternative<db::NullValue>(value) ||
+           (type != ColumnType::UNKNOWN && value.index() == static_cast<size_t>(type));
+}
+
+CompareKernel select_compare_kernel(ColumnType type, CompareOp op) noexcept {
+    return kCompareKernels[static_cast<size_t>(type)][static_cast<size_t>(op)];
+}
+
+}
@@ -0,0 +1,173 @@
+#include "sql/StatementLocks.hpp"
+#include "sql/executors/Constraints.hpp"
+#include <algorithm>
+#include <functional>
+#include <set>
+#include <utility>
+
+namespace sql {
+
+namespace {
+struct TableLock {
+    const db::Table* table;
+    bool exclusive;
+};
+
+void add_lock(std::vector<TableLock>& locks, const db::Table* table, bool exclusive) {
+    if (table) locks.push_back({table, exclusive});
+}
+
+// Таблицы, на которые ссылаются внешние ключи (проверяются при INSERT/UPDATE)
+void add_referenced(std::vector<TableLock>& locks, const db::Database& db, const db::Table& table) {
+    for (const auto& column : table.get_columns()) {
+        for (const auto& fk : column.get_foreign_keys()) {
+            add_lock(locks, db.get_table(fk.referenced_table), false);
+        }
+    }
+}
+
+// Таблицы, ссылающиеся на изменяемую (UPDATE/DELETE), включая ее саму. RESTRICT их
+// только проверяет, CASCADE и SET NULL меняют, и изменения расходятся по их ссылкам дальше.
+// visited - таблицы, уже пройденные с удалением (true) или изменением ключей (false)
+void add_referencing(std::vector<TableLock>& locks, const db::Database& db, std::string_view table_name, bool deleting,
+                     std::set<std::pair<std::string_view, bool>>& visited) {
+    for (const auto& ref : executors::find_referencing_columns(db, table_name)) {
+        const auto action = deleting ? ref.fk->on_delete : ref.fk->on_update;
+        if (action == db::ForeignKeyAction::RESTRICT) {
+            add_lock(locks, ref.table, false);
+            continue;
+        }
+        add_lock(locks, ref.table, true);
+        const bool child_deleting = deleting && action == db::ForeignKeyAction::CASCADE;
+        // Перенесенный ключ проверяется по остальным внешним ключам строки
+        if (!child_deleting) add_referenced(locks, db, *ref.table);
+        if (visited.emplace(ref.table->get_name(), child_deleting).second) {
+            add_referencing(locks, db, ref.table->get_name(), child_deleting, visited);
+        }
+    }
+}
+
+void add_referencing(std::vector<TableLock>& locks, const db::Database& db, std::string_view table_name, bool deleting) {
+    std::set<std::pair<std::string_view, bool>> visited{{table_name, deleting}};
+    add_referencing(locks, db, table_name, deleting, visited);
+}
+
+std::vector<TableLock> collect_table_locks(const ParseResult& pr, const db::Database& db) {
+    std::vector<TableLock> locks;
+    switch (pr.type) {
+    case CommandType::INSERT: {
+        const auto* table = db.get_table(std::get<Insert>(pr.command).table_name);
+        if (!table) break;
+        add_lock(locks, table, true);
+        add_referenced(locks, db, *table);
+        break;
+    }
+    case CommandType::UPDATE: {
+        const auto& name = std::get<Update>(pr.command).table_name;
+        const auto* table = db.get_table(name);
+        if (!table) break;
+        add_lock(locks, table, true);
+        add_referenced(locks, db, *table);
+        add_referencing(locks, db, name, false);
+        break;
+    }
+    case CommandType::DELETE: {
+        const auto& name = std::get<Delete>(pr.command).table_name;
+        add_lock(locks, db.get_table(name), true);
+        add_referencing(locks, db, name, true);
+        break;
+    }
+    case CommandType::COPY: {
+        const auto& cmd = std::get<Copy>(pr.command);
+        const auto* table = db.get_table(cmd.table_name);
+        if (!table || !cmd.from) break;
+        add_lock(locks, table, true);
+        add_referenced(locks, db, *table);
+        break;
+    }
+    default:
+        break;
+    }
+
+    // Единый порядок захвата исключает взаимные блокировки между сессиями
+    std::sort(locks.begin(), locks.end(), [](const TableLock& a, const TableLock& b) {
+        return std::less<const db::Table*>()(a.table, b.table);
+    });
+    std::vector<TableLock> merged;
+    for (const auto& lock : locks) {
+        if (!merged.empty() && merged.back().table == lock.table) {
+            merged.back().exclusive = merged.back().exclusive || lock.exclusive;
+        } else {
+            merged.push_back(lock);
+        }
+    }
+    return merged;
+}
+}
+
+bool is_schema_change(CommandType type) noexcept {
+    return type == CommandType::CREATE_DATABASE || type == CommandType::DROP_DATABASE ||
+           type == CommandType::CREATE_TABLE || type == CommandType::DROP_TABLE;
+}
+
+bool is_write(const ParseResult& pr) noexcept {
+    switch (pr.type) {
+    case CommandType::INSERT:
+    case CommandType::UPDATE:
+    case CommandType::DELETE:
+        return true;
+    case CommandType::COPY:
+        return std::get<Copy>(pr.command).from;
+    default:
+        return false;
+    }
+}
+
+const ParseResult& resolve_statement(const ParseResult& pr, const Session& session) {
+    if (pr.type != CommandType::EXECUTE) return pr;
+    auto it = session.prepared.find(std::get<Execute>(pr.command).name);
+    return it != session.prepared.end() ? it->second.parsed : pr;
+}
+
+StatementLocks::StatementLocks(const ParseResult& pr, const db::StorageEngine& engine, Session& session,
+                               db::Transaction* transaction) {
+    const auto deadline = db::RwLock::Clock::now() + kLockTimeout;
+    if (session.transaction) {
+        const auto* db = engine.get_database(session.current_db);
+        if (!db) return;
+
+        // Повышение разделяемой блокировки до эксклюзивной могло бы привести
+        // к взаимной блокировке, поэтому транзакция сразу берет эксклюзивные
+        std::vector<db::TableLockRequest> locks;
+        for (const auto& lock : collect_table_locks(resolve_statement(pr, session), *db)) {
+            locks.push_back({&lock.table->get_lock(), true});
+        }
+        acquired_ = session.transaction->lock_tables(locks, deadline);
+        return;
+    }
+
+    // Ожидание ограничено, чтобы оператор не висел за долгой транзакцией
+    if (is_schema_change(pr.type)) {
+        catalog_exclusive_ = std::unique_lock(engine.get_catalog_lock(), deadline);
+        acquired_ = catalog_exclusive_.owns_lock();
+        return;
+    }
+    catalog_shared_ = std::shared_lock(engine.get_catalog_lock(), deadline);
+    if (!catalog_shared_.owns_lock()) {
+        acquired_ = false;
+        return;
+    }
+
+    const auto* db = engine.get_database(session.current_db);
+    if (!db || !transaction) return;
+
+    // Блокировки таблиц отдаются неявной транзакции: она снимает их при
+    // фиксации, не дожидаясь сброса журнала на диск
+    std::vector<db::TableLockRequest> locks;
+    for (const auto& lock : collect_table_locks(resolve_statement(pr, session), *db)) {
+        locks.push_back({&lock.table->get_lock(), lock.exclusive});
+    }
+    acquired_ = transaction->lock_tables(locks, deadline);
+}
+
+}
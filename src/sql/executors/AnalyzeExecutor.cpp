@@ -0,0 +1,28 @@
+#include "sql/executors/AnalyzeExecutor.hpp"
+#include "db/Statistics.hpp"
+
+namespace sql {
+namespace executors {
+
+ExecResult execute_analyze(const Analyze& cmd, db::StorageEngine& engine, const std::string& current_db) {
+    if (current_db.empty()) return {false, "No database selected", ""};
+
+    auto* db = engine.get_database(current_db);
+    if (!db) return {false, "Database not found", ""};
+
+    // Статистика собирается по зафиксированным строкам без блокировки таблиц
+    if (!cmd.table_name.empty()) {
+        auto* table = db->get_table(cmd.table_name);
+        if (!table) return {false, "Table not found", ""};
+        table->set_statistics(db::collect_statistics(*table));
+        return {true, "", "Analyzed table " + cmd.table_name};
+    }
+
+    for (const auto& [name, table] : db->get_tables()) {
+        db->get_table(name)->set_statistics(db::collect_statistics(table));
+    }
+    return {true, "", "Analyzed " + std::to_string(db->get_tables().size()) + " table(s)"};
+}
+
+}
+}
@@ -0,0 +1,385 @@
+#include "sql/executors/Constraints.hpp"
+#include "sql/Profiler.hpp"
+#include "sql/QueryArena.hpp"
+#include "sql/ScanKernels.hpp"
+#include "db/MemoryTracker.hpp"
+
+namespace sql {
+namespace executors {
+
+ValueSet collect_column_values(const db::Table& table, int column_index) {
+    ValueSet keys(QueryArena::current());
+    if (column_index == -1) return keys;
+    auto rows = table.scan();
+    keys.reserve(rows.size());
+    for (const auto& row : rows) {
+        if (!row.is_current()) continue;
+        const auto& row_values = row.get_values();
+        if (column_index < static_cast<int>(row_values.size()) &&
+            !std::holds_alternative<db::NullValue>(row_values[column_index])) {
+            keys.insert(&row_values[column_index]);
+        }
+    }
+    return keys;
+}
+
+std::vector<ReferencingColumn> find_referencing_columns(const db::Database& db, std::string_view table_name, std::string_view column_name) {
+    std::vector<ReferencingColumn> result;
+    for (const auto& [other_table_name, other_table] : db.get_tables()) {
+        const auto& other_columns = other_table.get_columns();
+        for (size_t i = 0; i < other_columns.size(); ++i) {
+            for (const auto& fk : other_columns[i].get_foreign_keys()) {
+                if (fk.referenced_table != table_name) continue;
+                if (!column_name.empty() && fk.referenced_column != column_name) continue;
+                result.push_back({other_table_name, &other_table, i, &fk});
+            }
+        }
+    }
+    return result;
+}
+
+bool check_foreign_keys(const db::Database& db, const db::Table& table, std::span<const db::Row> rows, std::string& error) {
+    const auto& columns = table.get_columns();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const auto& column = columns[i];
+        if (column.get_foreign_keys().empty()) continue;
+
+        ValueSet batch_values(QueryArena::current());
+        for (const auto& row : rows) {
+            const auto& value = row.get_values()[i];
+            if (!std::holds_alternative<db::NullValue>(value)) {
+                batch_values.insert(&value);
+            }
+        }
+        if (batch_values.empty()) continue;
+
+        for (const auto& fk : column.get_foreign_keys()) {
+            const auto* ref_table = db.get_table(fk.referenced_table);
+            if (!ref_table) {
+                error = "Referenced table '" + fk.referenced_table + "' not found for foreign key constraint";
+                return false;
+            }
+
+            // Колонка могла исчезнуть, если таблицу пересоздали после CREATE ссылающейся
+            const int ref_column = ref_table->find_column(fk.referenced_column);
+            if (ref_column == -1) {
+                error = "Referenced column '" + fk.referenced_column + "' not found in table '" +
+                        fk.referenced_table + "' for foreign key constraint";
+                return false;
+            }
+            ValueSet ref_keys = collect_column_values(*ref_table, ref_column);
+            // Строка может ссылаться на строку той же вставки
+            if (ref_table == &table) {
+                for (const auto& row : rows) {
+                    const auto& value = row.get_values()[ref_column];
+                    if (!std::holds_alternative<db::NullValue>(value)) ref_keys.insert(&value);
+                }
+            }
+            for (const auto* value : batch_values) {
+                if (!ref_keys.count(value)) {
+                    error = "Foreign key constraint violation: value '" + db::value_to_string(*value) +
+                            "' does not exist in referenced table '" + fk.referenced_table +
+                            "' column '" + fk.referenced_column + "'";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+size_t rows_memory(std::span<const db::Row> rows) {
+    size_t bytes = 0;
+    for (const auto& row : rows) bytes += sizeof(db::Row) + db::row_memory(row).total();
+    return bytes;
+}
+
+bool check_memory_bytes(size_t bytes, std::string& error) {
+    if (db::MemoryTracker::can_allocate(bytes)) return true;
+    error = "Memory limit exceeded: " + std::to_string(db::MemoryTracker::used()) + " of " +
+            std::to_string(db::MemoryTracker::limit()) + " bytes in use, statement needs " + std::to_string(bytes) + " more";
+    return false;
+}
+
+namespace {
+bool is_null(const db::Value& value) noexcept {
+    return std::holds_alternative<db::NullValue>(value);
+}
+
+// Прежний ключ родителя -> новая версия его строки
+using KeyChanges = std::pmr::unordered_map<const db::Value*, size_t, ValuePtrHash, ValuePtrEqual>;
+}
+
+bool check_memory_limit(std::span<const db::Row> rows, std::string& error) {
+    return check_memory_bytes(rows_memory(rows), error);
+}
+
+ReferentialActions::TableChanges::TableChanges(db::Table& table, std::pmr::memory_resource* memory)
+    : name(table.get_name()), table(&table), deleted(memory), deleted_set(memory), updated(memory),
+      new_versions(memory), version_of(memory), changes(memory) {}
+
+ReferentialActions::ReferentialActions(db::Database& db) : db_(db), tables_(QueryArena::current()) {}
+
+ReferentialActions::TableChanges& ReferentialActions::changes_for(db::Table& table) {
+    for (auto& changes : tables_) {
+        if (changes.table == &table) return changes;
+    }
+    return tables_.emplace_back(table, QueryArena::current());
+}
+
+void ReferentialActions::delete_row(db::Table& table, const db::Row& row) {
+    add_delete(changes_for(table), row);
+}
+
+void ReferentialActions::update_row(db::Table& table, const db::Row& row, db::Row new_row) {
+    auto& changes = changes_for(table);
+    const auto& old_values = row.get_values();
+    const auto& new_values = new_row.get_values();
+    const size_t version = changes.new_versions.size();
+    for (size_t i = 0; i < old_values.size() && i < new_values.size(); ++i) {
+        if (!db::value_equals(old_values[i], new_values[i])) changes.changes.push_back({version, i, false});
+    }
+    changes.version_of.emplace(&row, version);
+    changes.updated.push_back(&row);
+    changes.new_versions.push_back(std::move(new_row));
+}
+
+bool ReferentialActions::add_delete(TableChanges& changes, const db::Row& row) {
+    if (!changes.deleted_set.insert(&row).second) return false;
+    changes.deleted.push_back(&row);
+    return true;
+}
+
+bool ReferentialActions::set_value(TableChanges& changes, const db::Row& row, size_t column, const db::Value& value) {
+    auto it = changes.version_of.find(&row);
+    const db::Value& current = it == changes.version_of.end() ? row.get_values()[column]
+                                                              : changes.new_versions[it->second].get_values()[column];
+    if (!db::value_equals(current, row.get_values()[column]) || db::value_equals(current, value)) return false;
+
+    // value может лежать в new_versions той же таблицы (ссылка на себя),
+    // а добавление версии перемещает вектор
+    db::Value new_value = value;
+    if (it == changes.version_of.end()) {
+        it = changes.version_of.emplace(&row, changes.new_versions.size()).first;
+        changes.updated.push_back(&row);
+        changes.new_versions.emplace_back(row.get_values());
+    }
+    changes.new_versions[it->second].get_values()[column] = std::move(new_value);
+    changes.changes.push_back({it->second, column, true});
+    return true;
+}
+
+bool ReferentialActions::process_wave(TableChanges& parent, std::string& error) {
+    const size_t deleted_from = parent.next_deleted;
+    const size_t changes_from = parent.next_change;
+    parent.next_deleted = parent.deleted.size();
+    parent.next_change = parent.changes.size();
+
+    for (const auto& ref : find_referencing_columns(db_, parent.name)) {
+        const int key_column = parent.table->find_column(ref.fk->referenced_column);
+        if (key_column == -1) continue;
+        const auto key = static_cast<size_t>(key_column);
+
+        ValueSet deleted_keys(QueryArena::current());
+        for (size_t i = deleted_from; i < parent.next_deleted; ++i) {
+            const auto& values = parent.deleted[i]->get_values();
+            if (key < values.size() && !is_null(values[key])) deleted_keys.insert(&values[key]);
+        }
+        KeyChanges updated_keys(QueryArena::current());
+        for (size_t i = changes_from; i < parent.next_change; ++i) {
+            const auto& change = parent.changes[i];
+            const db::Row* row = parent.updated[change.version];
+            if (change.column != key || parent.deleted_set.count(row)) continue;
+            const auto& old_value = row->get_values()[key];
+            if (!is_null(old_value)) updated_keys.emplace(&old_value, change.version);
+        }
+        if (deleted_keys.empty() && updated_keys.empty()) continue;
+
+        // Ссылки на исчезающие ключи ищутся одним проходом по дочерней таблице
+        auto* child = db_.get_table(ref.table_name);
+        auto& child_changes = changes_for(*child);
+        auto rows = child->scan();
+        OperatorScope scope("FK Check", ref.table_name);
+        scope.add_blocks(rows.chunk_count());
+        scope.add_rows_in(rows.size());
+        size_t affected = 0;
+        for (const auto& row : rows) {
+            if (!row.is_current() || child_changes.deleted_set.count(&row)) continue;
+            const auto& values = row.get_values();
+            if (ref.column >= values.size() || is_null(values[ref.column])) continue;
+
+            const db::Value& value = values[ref.column];
+            const bool deleting = deleted_keys.count(&value) > 0;
+            const db::Value* new_key = nullptr;
+            if (!deleting) {
+                auto found = updated_keys.find(&value);
+                if (found == updated_keys.end()) continue;
+                new_key = &parent.new_versions[found->second].get_values()[key];
+            }
+            // Строка, которой оператор или действие уже дали другую ссылку,
+            // на исчезающий ключ больше не ссылается
+            if (auto own = child_changes.version_of.find(&row); own != child_changes.version_of.end() &&
+                !db::value_equals(child_changes.new_versions[own->second].get_values()[ref.column], value)) {
+                continue;
+            }
+
+            switch (deleting ? ref.fk->on_delete : ref.fk->on_update) {
+            case db::ForeignKeyAction::RESTRICT: {
+                // Ошибка в самой изменяемой таблице описывается так же, как без каскадов
+                const std::string row_name = &parent == &tables_.front() ? "row" : "row in table '" + parent.name + "'";
+                if (deleting) {
+                    error = "Cannot delete " + row_name + ": Referenced by table '" + ref.table_name +
+                            "' column '" + ref.fk->column_name + "'";
+                } else {
+                    error = "Cannot update " + row_name + ": value '" + db::value_to_string(value) +
+                            "' in column '" + ref.fk->referenced_column + "' is referenced by table '" +
+                            ref.table_name + "' column '" + ref.fk->column_name + "'";
+                }
+                return false;
+            }
+            case db::ForeignKeyAction::CASCADE:
+                if (deleting ? add_delete(child_changes, row) : set_value(child_changes, row, ref.column, *new_key)) {
+                    ++affected;
+                }
+                break;
+            case db::ForeignKeyAction::SET_NULL:
+                if (set_value(child_changes, row, ref.column, db::NullValue{})) ++affected;
+                break;
+            }
+        }
+        scope.add_rows_out(affected);
+    }
+    return true;
+}
+
+bool ReferentialActions::resolve(std::string& error) {
+    // Каждая волна только добавляет строки, а строка и колонка меняются
+    // не больше одного раза, поэтому обход завершается и на циклах ссылок
+    for (bool pending = true; pending;) {
+        pending = false;
+        for (size_t i = 0; i < tables_.size(); ++i) {
+            auto& changes = tables_[i];
+            if (changes.next_deleted == changes.deleted.size() && changes.next_change == changes.changes.size()) continue;
+            pending = true;
+            if (!process_wave(changes, error)) return false;
+        }
+    }
+    return check_written_values(error);
+}
+
+const ReferentialActions::TableChanges* ReferentialActions::find_changes(const db::Table& table) const {
+    for (const auto& changes : tables_) {
+        if (changes.table == &table) return &changes;
+    }
+    return nullptr;
+}
+
+ValueSet ReferentialActions::final_values(const db::Table& table, size_t column) const {
+    const auto* changes = find_changes(table);
+    ValueSet keys(QueryArena::current());
+    auto rows = table.scan();
+    for (const auto& row : rows) {
+        if (!row.is_current()) continue;
+        if (changes && (changes->deleted_set.count(&row) || changes->version_of.count(&row))) continue;
+        const auto& values = row.get_values();
+        if (column < values.size() && !is_null(values[column])) keys.insert(&values[column]);
+    }
+    if (!changes) return keys;
+    for (size_t i = 0; i < changes->updated.size(); ++i) {
+        if (changes->deleted_set.count(changes->updated[i])) continue;
+        const auto& values = changes->new_versions[i].get_values();
+        if (column < values.size() && !is_null(values[column])) keys.insert(&values[column]);
+    }
+    return keys;
+}
+
+bool ReferentialActions::check_written_values(std::string& error) const {
+    for (const auto& changes : tables_) {
+        const auto& columns = changes.table->get_columns();
+        std::pmr::vector<ValueSet> written(columns.size(), QueryArena::current());
+        std::pmr::vector<bool> by_action(columns.size(), false, QueryArena::current());
+        for (const auto& change : changes.changes) {
+            if (changes.deleted_set.count(changes.updated[change.version])) continue;
+            const auto& value = changes.new_versions[change.version].get_values()[change.column];
+            if (is_null(value)) continue;
+            written[change.column].insert(&value);
+            if (change.by_action) by_action[change.column] = true;
+        }
+
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (written[i].empty()) continue;
+            const auto& column = columns[i];
+            const auto type = column_type_from(column.get_type());
+            for (const auto* value : written[i]) {
+                if (!value_matches_type(*value, type)) {
+                    error = "Type mismatch for column '" + column.get_name() + "' in table '" + changes.name +
+                            "': expected " + column.get_type() + ", got value '" + db::value_to_string(*value) + "'";
+                    return false;
+                }
+            }
+
+            for (const auto& fk : column.get_foreign_keys()) {
+                const auto* ref_table = db_.get_table(fk.referenced_table);
+                if (!ref_table) {
+                    error = "Referenced table '" + fk.referenced_table + "' not found for foreign key constraint";
+                    return false;
+                }
+                // Значения оператора уже сверены с таблицей до изменений; повтор нужен,
+                // только если ее ключи меняет этот же оператор
+                if (!by_action[i] && !find_changes(*ref_table)) continue;
+
+                const int ref_column = ref_table->find_column(fk.referenced_column);
+                if (ref_column == -1) {
+                    error = "Referenced column '" + fk.referenced_column + "' not found in table '" +
+                            fk.referenced_table + "' for foreign key constraint";
+                    return false;
+                }
+                ValueSet keys = final_values(*ref_table, static_cast<size_t>(ref_column));
+                for (const auto* value : written[i]) {
+                    if (!keys.count(value)) {
+                        error = "Foreign key constraint violation: value '" + db::value_to_string(*value) +
+                                "' in table '" + changes.name + "' column '" + column.get_name() +
+                                "' does not exist in referenced table '" + fk.referenced_table +
+                                "' column '" + fk.referenced_column + "'";
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool ReferentialActions::check_memory_limit(std::string& error) const {
+    size_t bytes = 0;
+    for (const auto& changes : tables_) bytes += rows_memory(changes.new_versions);
+    return check_memory_bytes(bytes, error);
+}
+
+void ReferentialActions::apply(const db::StatementVersion& version) {
+    const size_t statement_rows = tables_.empty() ? 0 : tables_.front().deleted.size() + tables_.front().updated.size();
+    size_t retired = 0;
+    for (auto& changes : tables_) {
+        for (const auto* row : changes.deleted) version.transaction->retire(db_.get_name(), *changes.table, *row);
+        retired += changes.deleted.size();
+
+        // Удаление строки важнее изменения ее ключа
+        std::pmr::vector<db::Row> rows(QueryArena::current());
+        for (size_t i = 0; i < changes.updated.size(); ++i) {
+            if (changes.deleted_set.count(changes.updated[i])) continue;
+            version.transaction->retire(db_.get_name(), *changes.table, *changes.updated[i]);
+            rows.push_back(std::move(changes.new_versions[i]));
+        }
+        retired += rows.size();
+        if (!rows.empty()) version.transaction->insert_rows(db_.get_name(), *changes.table, rows);
+    }
+    cascaded_rows_ = retired > statement_rows ? retired - statement_rows : 0;
+}
+
+std::string cascaded_suffix(const ReferentialActions& actions) {
+    if (actions.cascaded_rows() == 0) return "";
+    return ", " + std::to_string(actions.cascaded_rows()) + " referencing row(s) by foreign key actions";
+}
+
+}
+}
@@ -0,0 +1,514 @@
+#include "sql/executors/CopyExecutor.hpp"
+#include "sql/executors/Constraints.hpp"
+#include "sql/ScanKernels.hpp"
+#include "db/ValueUtils.hpp"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+namespace sql {
+namespace executors {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t kReadChunkSize = 8 << 20;
+constexpr size_t kMinPartSize = 256 << 10;
+constexpr size_t kWriteBufferSize = 1 << 20;
+
+// Участок буфера, содержащий только целые записи
+struct Part {
+    size_t begin;
+    size_t end;
+    size_t first_record;
+};
+
+struct ParsedPart {
+    std::vector<db::Row> rows;
+    std::string error;
+};
+
+// Кавычка открывает поле, только если стоит в его начале, как в parse_record;
+// внутри такого поля "" - экранированная кавычка
+class QuoteState {
+public:
+    // Возвращает true, если c завершает запись
+    bool end_of_record(char c) noexcept {
+        if (in_quotes_) {
+            if (c == '"') {
+                in_quotes_ = false;
+                after_quote_ = true;
+            }
+            return false;
+        }
+        if (c == '"' && (field_start_ || after_quote_)) {
+            in_quotes_ = true;
+            field_start_ = after_quote_ = false;
+            return false;
+        }
+        after_quote_ = false;
+        field_start_ = c == ',' || c == '\n';
+        return c == '\n';
+    }
+
+private:
+    bool in_quotes_ = false;
+    bool field_start_ = true;
+    bool after_quote_ = false;
+};
+
+std::vector<Part> split_records(std::string_view data, bool final_chunk, size_t parts, size_t& next_record, size_t& consumed) {
+    std::vector<Part> result;
+    const size_t target = std::max<size_t>(data.size() / parts, 1);
+    QuoteState quotes;
+    size_t part_begin = 0;
+    size_t part_first = next_record;
+    size_t record = next_record;
+    size_t last_boundary = 0;
+
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (quotes.end_of_record(data[i])) {
+            ++record;
+            last_boundary = i + 1;
+            if (last_boundary - part_begin >= target && result.size() + 1 < parts) {
+                result.push_back({part_begin, last_boundary, part_first});
+                part_begin = last_boundary;
+                part_first = record;
+            }
+        }
+    }
+
+    if (final_chunk) last_boundary = data.size();
+    if (last_boundary > part_begin) result.push_back({part_begin, last_boundary, part_first});
+    consumed = last_boundary;
+    next_record = record;
+    return result;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// Преобразование поля в значение колонки; выбирается один раз на колонку
+using FieldConverter = bool (*)(std::string_view field, bool quoted, db::Value& out);
+
+template <ColumnType Type>
+bool convert_field(std::string_view field, bool quoted, db::Value& out) {
+    if (!quoted && field.empty()) {
+        out = db::NullValue{};
+        return true;
+    }
+    if constexpr (Type == ColumnType::STR) {
+        out = std::string(field);
+        return true;
+    } else if constexpr (Type == ColumnType::INT || Type == ColumnType::FLOAT) {
+        field = trim(field);
+        const char* last = field.data() + field.size();
+        std::conditional_t<Type == ColumnType::INT, int, float> v = 0;
+        auto [ptr, ec] = std::from_chars(field.data(), last, v);
+        if (ec != std::errc() || ptr != last) return false;
+        out = v;
+        return true;
+    } else if constexpr (Type == ColumnType::BOOL) {
+        field = trim(field);
+        if (field == "true" || field == "TRUE" || field == "1") {
+            out = true;
+            return true;
+        }
+        if (field == "false" || field == "FALSE" || field == "0") {
+            out = false;
+            return true;
+        }
+        return false;
+    } else {
+        return false;
+    }
+}
+
+// Индексы: ColumnType
+constexpr FieldConverter kFieldConverters[] = {
+    convert_field<ColumnType::INT>,
+    convert_field<ColumnType::FLOAT>,
+    convert_field<ColumnType::STR>,
+    convert_field<ColumnType::BOOL>,
+    convert_field<ColumnType::UNKNOWN>,
+};
+
+std::vector<FieldConverter> select_converters(const std::vector<db::Column>& columns) {
+    std::vector<FieldConverter> converters;
+    converters.reserve(columns.size());
+    for (const auto& column : columns) {
+        converters.push_back(kFieldConverters[static_cast<size_t>(column_type_from(column.get_type()))]);
+    }
+    return converters;
+}
+
+bool parse_record(std::string_view record, const std::vector<db::Column>& columns, const std::vector<FieldConverter>& converters,
+                  std::vector<db::Value>& values, std::string& error) {
+    size_t pos = 0;
+    std::string unescaped;
+    for (;;) {
+        if (values.size() == columns.size()) {
+            error = "too many fields";
+            return false;
+        }
+
+        std::string_view field;
+        bool quoted = pos < record.size() && record[pos] == '"';
+        if (quoted) {
+            unescaped.clear();
+            ++pos;
+            bool closed = false;
+            while (pos < record.size()) {
+                if (record[pos] == '"') {
+                    if (pos + 1 < record.size() && record[pos + 1] == '"') {
+                        unescaped += '"';
+                        pos += 2;
+                        continue;
+                    }
+                    closed = true;
+                    ++pos;
+                    break;
+                }
+                unescaped += record[pos++];
+            }
+            if (!closed || (pos < record.size() && record[pos] != ',')) {
+                error = "malformed quoted field";
+                return false;
+            }
+            field = unescaped;
+        } else {
+            size_t comma = record.find(',', pos);
+            if (comma == std::string_view::npos) comma = record.size();
+            field = record.substr(pos, comma - pos);
+            pos = comma;
+        }
+
+        const auto& column = columns[values.size()];
+        db::Value value;
+        if (!converters[values.size()](field, quoted, value)) {
+            error = "invalid " + column.get_type() + " value '" + std::string(field) + "' for column '" + column.get_name() + "'";
+            return false;
+        }
+        values.push_back(std::move(value));
+
+        if (pos >= record.size()) break;
+        ++pos;
+    }
+
+    if (values.size() != columns.size()) {
+        error = "expected " + std::to_string(columns.size()) + " fields, got " + std::to_string(values.size());
+        return false;
+    }
+    return true;
+}
+
+void parse_records(std::string_view data, size_t& record_no, bool skip_header, const std::vector<db::Column>& columns,
+                   const std::vector<FieldConverter>& converters, ParsedPart& out) {
+    size_t pos = 0;
+    QuoteState quotes;
+    size_t record_begin = 0;
+    while (pos <= data.size()) {
+        if (pos < data.size() && !quotes.end_of_record(data[pos])) {
+            ++pos;
+            continue;
+        }
+
+        // После последнего перевода строки записи нет; пустая строка в середине -
+        // запись из одного NULL, так COPY TO пишет такие строки одноколоночных таблиц
+        if (pos == data.size() && record_begin == pos) break;
+        std::string_view record = data.substr(record_begin, pos - record_begin);
+        if (!record.empty() && record.back() == '\r') record.remove_suffix(1);
+        if (!(skip_header && record_no == 1)) {
+            std::vector<db::Value> values;
+            values.reserve(columns.size());
+            std::string error;
+            if (!parse_record(record, columns, converters, values, error)) {
+                out.error = "line " + std::to_string(record_no) + ": " + error;
+                return;
+            }
+            out.rows.emplace_back(std::move(values));
+        }
+        ++record_no;
+        record_begin = ++pos;
+    }
+}
+
+// Исключение разбора (например, bad_alloc) становится ошибкой участка, а не выходит из потока
+void parse_part(std::string_view data, size_t first_record, bool skip_header, const std::vector<db::Column>& columns,
+                const std::vector<FieldConverter>& converters, ParsedPart& out) noexcept {
+    size_t record_no = first_record;
+    try {
+        parse_records(data, record_no, skip_header, columns, converters, out);
+    } catch (const std::exception& e) {
+        out.error = "line " + std::to_string(record_no) + ": " + e.what();
+    }
+}
+
+// Потоки разбора на всю команду COPY: каждый кусок файла раздается им заново,
+// без создания потоков на кусок. Участок 0 разбирает вызывающий поток
+class PartWorkers {
+public:
+    explicit PartWorkers(size_t count) {
+        threads_.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            try {
+                threads_.emplace_back([this](std::stop_token stop) { work(stop); });
+            } catch (const std::system_error&) {
+                break;  // Без новых потоков разбор идет на уже запущенных
+            }
+        }
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return threads_.size() + 1; }
+
+    // job(i) для i из [0, parts); job не должен бросать исключений
+    void run(size_t parts, const std::function<void(size_t)>& job) {
+        std::unique_lock lock(mutex_);
+        job_ = &job;
+        next_ = 0;
+        parts_ = parts;
+        pending_ = parts;
+        wake_.notify_all();
+        take_jobs(lock);
+        done_.wait(lock, [this] { return pending_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void work(std::stop_token stop) {
+        std::unique_lock lock(mutex_);
+        while (wake_.wait(lock, stop, [this] { return job_ && next_ < parts_; })) take_jobs(lock);
+    }
+
+    void take_jobs(std::unique_lock<std::mutex>& lock) {
+        while (job_ && next_ < parts_) {
+            const size_t index = next_++;
+            const auto* job = job_;
+            lock.unlock();
+            (*job)(index);
+            lock.lock();
+            if (--pending_ == 0) done_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable_any wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t next_ = 0;
+    size_t parts_ = 0;
+    size_t pending_ = 0;
+    // Последним полем: потоки останавливаются и присоединяются раньше, чем разрушается остальное
+    std::vector<std::jthread> threads_;
+};
+
+void write_field(std::ostream& os, const db::Value& value) {
+    char buf[64];
+    if (std::holds_alternative<int>(value)) {
+        auto res = std::to_chars(buf, buf + sizeof(buf), std::get<int>(value));
+        os.write(buf, res.ptr - buf);
+    } else if (std::holds_alternative<float>(value)) {
+        auto res = std::to_chars(buf, buf + sizeof(buf), std::get<float>(value));
+        os.write(buf, res.ptr - buf);
+    } else if (std::holds_alternative<bool>(value)) {
+        os << (std::get<bool>(value) ? "true" : "false");
+    } else if (std::holds_alternative<std::string>(value)) {
+        const auto& s = std::get<std::string>(value);
+        if (!s.empty() && s.find_first_of(",\"\r\n") == std::string::npos) {
+            os.write(s.data(), s.size());
+            return;
+        }
+        os.put('"');
+        for (char c : s) {
+            if (c == '"') os.put('"');
+            os.put(c);
+        }
+        os.put('"');
+    }
+}
+
+// Число строк уходит клиенту результатом: текст ExecResult::result сервер не отправляет
+ExecResult copied(size_t count) {
+    ExecResult result{true, "", "Copied " + std::to_string(count) + " row(s)"};
+    result.result_set.add_column("copied", "INT");
+    result.result_set.append_value(0, static_cast<int>(count));
+    return result;
+}
+
+bool is_within(const fs::path& dir, const fs::path& path) {
+    return std::mismatch(dir.begin(), dir.end(), path.begin(), path.end()).first == dir.end();
+}
+
+// Путь из COPY внутри CopyDirectory; символические ссылки тоже не выводят за его пределы
+bool resolve_path(const std::string& path, std::string& resolved, std::string& error) {
+    const auto& dir = CopyDirectory::get();
+    if (dir.empty()) {
+        error = "COPY is disabled: the server was started without --copy-dir";
+        return false;
+    }
+    const fs::path relative(path);
+    bool escapes = path.empty() || relative.has_root_path();
+    for (const auto& part : relative) escapes = escapes || part == "..";
+    if (escapes) {
+        error = "COPY path '" + path + "' must be relative to the COPY directory and must not contain '..'";
+        return false;
+    }
+
+    std::error_code ec;
+    const fs::path full = fs::weakly_canonical(fs::path(dir) / relative, ec);
+    if (ec || !is_within(dir, full)) {
+        error = "COPY path '" + path + "' is outside the COPY directory";
+        return false;
+    }
+    resolved = full.string();
+    return true;
+}
+
+ExecResult copy_from(const Copy& cmd, db::Database& db, db::Table& table, db::Transaction& transaction) {
+    std::string path, error;
+    if (!resolve_path(cmd.path, path, error)) return {false, error, ""};
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs.is_open()) return {false, "Cannot open file '" + cmd.path + "'", ""};
+
+    const auto& columns = table.get_columns();
+    const auto converters = select_converters(columns);
+    PartWorkers workers(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
+    std::vector<db::Row> rows;
+    size_t rows_bytes = 0;
+    bool reclaimed = false;
+    std::string buffer;
+    size_t next_record = 1;
+    for (;;) {
+        size_t carry = buffer.size();
+        buffer.resize(carry + kReadChunkSize);
+        ifs.read(buffer.data() + carry, kReadChunkSize);
+        buffer.resize(carry + static_cast<size_t>(ifs.gcount()));
+        // Ошибка чтения - не конец файла: прочитанное начало не должно импортироваться
+        if (ifs.bad()) return {false, "Read from '" + cmd.path + "' failed", ""};
+        bool final_chunk = !ifs;
+
+        std::string_view data(buffer);
+        size_t part_count = std::clamp<size_t>(data.size() / kMinPartSize, 1, workers.size());
+        size_t consumed = 0;
+        auto parts = split_records(data, final_chunk, part_count, next_record, consumed);
+
+        std::vector<ParsedPart> parsed(parts.size());
+        workers.run(parts.size(), [&](size_t i) {
+            parse_part(data.substr(parts[i].begin, parts[i].end - parts[i].begin), parts[i].first_record,
+                       cmd.header, columns, converters, parsed[i]);
+        });
+
+        for (auto& part : parsed) {
+            if (!part.error.empty()) return {false, "COPY failed at " + part.error, ""};
+            // Предел памяти проверяется по мере разбора, а не после чтения всего файла;
+            // у предела сначала убираются мертвые версии таблицы
+            rows_bytes += rows_memory(part.rows);
+            if (!check_memory_bytes(rows_bytes, error) &&
+                (reclaimed || !(reclaimed = transaction.reclaim(table)) || !check_memory_bytes(rows_bytes, error))) {
+                return {false, error, ""};
+            }
+            if (rows.empty()) {
+                rows = std::move(part.rows);
+            } else {
+                rows.reserve(rows.size() + part.rows.size());
+                std::move(part.rows.begin(), part.rows.end(), std::back_inserter(rows));
+            }
+        }
+
+        buffer.erase(0, consumed);
+        if (final_chunk) break;
+    }
+
+    if (!check_foreign_keys(db, table, rows, error)) {
+        return {false, error, ""};
+    }
+
+    size_t count = rows.size();
+    transaction.insert_rows(db.get_name(), table, rows);
+    return copied(count);
+}
+
+ExecResult copy_to(const Copy& cmd, const db::Table& table, const db::StatementVersion& version) {
+    std::string path, error;
+    if (!resolve_path(cmd.path, path, error)) return {false, error, ""};
+    std::vector<char> io_buffer(kWriteBufferSize);
+    std::ofstream ofs;
+    ofs.rdbuf()->pubsetbuf(io_buffer.data(), static_cast<std::streamsize>(io_buffer.size()));
+    ofs.open(path, std::ios::binary | std::ios::trunc);
+    if (!ofs.is_open()) return {false, "Cannot open file '" + cmd.path + "'", ""};
+
+    const auto& columns = table.get_columns();
+    if (cmd.header) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            if (i > 0) ofs.put(',');
+            write_field(ofs, columns[i].get_name());
+        }
+        ofs.put('\n');
+    }
+
+    size_t count = 0;
+    for (const auto& row : table.scan()) {
+        if (!version.is_visible(row)) continue;
+        const auto& values = row.get_values();
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) ofs.put(',');
+            write_field(ofs, values[i]);
+        }
+        ofs.put('\n');
+        ++count;
+    }
+
+    ofs.flush();
+    if (!ofs) return {false, "Write to '" + cmd.path + "' failed", ""};
+    return copied(count);
+}
+
+}
+
+bool CopyDirectory::set(const std::string& path, std::string& error) {
+    if (path.empty()) {
+        path_.clear();
+        return true;
+    }
+    std::error_code ec;
+    const fs::path dir = fs::canonical(path, ec);
+    if (ec || !fs::is_directory(dir, ec)) {
+        error = "COPY directory '" + path + "' does not exist";
+        return false;
+    }
+    // Иначе COPY TO мог бы перезаписать снимок или журнал
+    const fs::path data_dir = fs::current_path(ec);
+    if (!ec && is_within(dir, data_dir)) {
+        error = "COPY directory '" + path + "' must not contain the database files";
+        return false;
+    }
+    path_ = dir.string();
+    return true;
+}
+
+ExecResult execute_copy(const Copy& cmd, db::StorageEngine& engine, const std::string& current_db, const db::StatementVersion& version) {
+    if (current_db.empty()) return {false, "No database selected", ""};
+
+    auto* db = engine.get_database(current_db);
+    if (!db) return {false, "Database not found", ""};
+
+    auto* table = db->get_table(cmd.table_name);
+    if (!table) return {false, "Table not found", ""};
+
+    return cmd.from ? copy_from(cmd, *db, *table, *version.transaction) : copy_to(cmd, *table, version);
+}
+
+}
+}
@@ -18,17 +18,16 @@ ExecResult execute_create_table(const CreateTable& cmd, db::StorageEngine& engin
     if (!db) return {false, "Database not found", ""};
     
     for (const auto& fk : cmd.foreign_keys) {
-        const auto* ref_table = db->get_table(fk.referenced_table);
-        if (!ref_table) {
-            return {false, "Referenced table '" + fk.referenced_table + "' does not exist", ""};
-        }
-        
+        // Ссылка на саму создаваемую таблицу сверяется с ее колонками
         bool ref_column_exists = false;
-        for (const auto& col : ref_table->get_columns()) {
-            if (col.get_name() == fk.referenced_column) {
-                ref_column_exists = true;
-                break;
+        if (fk.referenced_table == cmd.table_name) {
+            ref_column_exists = std::find(cmd.columns.begin(), cmd.columns.end(), fk.referenced_column) != cmd.columns.end();
+        } else {
+            const auto* ref_table = db->get_table(fk.referenced_table);
+            if (!ref_table) {
+                return {false, "Referenced table '" + fk.referenced_table + "' does not exist", ""};
             }
+            ref_column_exists = ref_table->find_column(fk.referenced_column) != -1;
         }
         if (!ref_column_exists) {
             return {false, "Referenced column '" + fk.referenced_column + "' does not exist in table '" + fk.referenced_table + "'", ""};
@@ -48,7 +47,7 @@ ExecResult execute_create_table(const CreateTable& cmd, db::StorageEngine& engin
     
     std::vector<db::ForeignKey> db_foreign_keys;
     for (const auto& fk : cmd.foreign_keys) {
-        db_foreign_keys.emplace_back(fk.column_name, fk.referenced_table, fk.referenced_column);
+        db_foreign_keys.emplace_back(fk.column_name, fk.referenced_table, fk.referenced_column, fk.on_delete, fk.on_update);
     }
     
     db->create_table(cmd.table_name, cmd.columns, cmd.types, db_foreign_keys);
@@ -0,0 +1,195 @@
+#include "sql/executors/ExplainExecutor.hpp"
+#include "sql/executors/Constraints.hpp"
+#include "sql/StatementLocks.hpp"
+#include "sql/Binder.hpp"
+#include "sql/Profiler.hpp"
+#include "sql/CostModel.hpp"
+#include "db/ValueUtils.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace sql {
+namespace executors {
+
+namespace {
+std::string format_ms(std::chrono::nanoseconds elapsed) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f ms", std::chrono::duration<double, std::milli>(elapsed).count());
+    return buf;
+}
+
+std::string format_value(const BoundValue& value) {
+    if (value.param != -1) return "$" + std::to_string(value.param + 1);
+    if (std::holds_alternative<std::string>(value.value)) return "'" + db::value_to_string(value.value) + "'";
+    return db::value_to_string(value.value);
+}
+
+// Условия выводятся в порядке вычисления: группы AND слева направо, затем OR
+std::string format_filter(const BoundWhere& where, const db::Table& table) {
+    const auto& columns = table.get_columns();
+    std::string text;
+    for (const auto& group : where.any_of) {
+        if (!text.empty()) text += " OR ";
+        text += '(';
+        for (size_t i = 0; i < group.size(); ++i) {
+            if (i > 0) text += " AND ";
+            text += columns[group[i].column].get_name() + " = " + format_value(group[i].value);
+        }
+        text += ')';
+    }
+    return text;
+}
+
+// Индексов нет, поэтому единственный путь доступа - последовательный
+// просмотр всех фрагментов таблицы в одном потоке
+void describe_scan(std::vector<std::string>& lines, const db::Table& table, const std::string& table_name, const BoundWhere& where) {
+    const auto rows = table.scan();
+    lines.push_back("  -> Seq Scan on " + table_name + " (chunks=" + std::to_string(rows.chunk_count()) +
+                    " versions=" + std::to_string(rows.size()) +
+                    " estimated rows=" + std::to_string(std::llround(estimate_rows(where, table))) + ")");
+    if (where.present) lines.push_back("        Filter: " + format_filter(where, table));
+    lines.push_back("        Workers: 1");
+    if (const auto statistics = table.get_statistics()) {
+        lines.push_back("        Statistics: analyzed rows=" + std::to_string(statistics->row_count));
+    } else {
+        lines.push_back("        Statistics: none, default selectivity");
+    }
+}
+
+void describe_referenced(std::vector<std::string>& lines, const db::Table& table, const std::vector<size_t>& columns) {
+    const auto& table_columns = table.get_columns();
+    for (size_t index : columns) {
+        for (const auto& fk : table_columns[index].get_foreign_keys()) {
+            lines.push_back("  -> FK Check: " + table_columns[index].get_name() + " references " +
+                            fk.referenced_table + "(" + fk.referenced_column + ")");
+        }
+    }
+}
+
+void describe_referencing(std::vector<std::string>& lines, const db::Database& db, const std::string& table_name, bool deleting,
+                          std::string_view column_name = {}) {
+    for (const auto& ref : find_referencing_columns(db, table_name, column_name)) {
+        const auto action = deleting ? ref.fk->on_delete : ref.fk->on_update;
+        lines.push_back("  -> FK Check: " + ref.table_name + "(" + ref.fk->column_name + ") references " +
+                        table_name + "(" + ref.fk->referenced_column + ") " + (deleting ? "ON DELETE " : "ON UPDATE ") +
+                        std::string(db::foreign_key_action_name(action)));
+    }
+}
+
+std::vector<std::string> describe(const BoundSelect& plan, const db::Database& db) {
+    const auto& table = *db.get_table(plan.table_name);
+    std::string projection;
+    for (size_t index : plan.columns) {
+        if (!projection.empty()) projection += ", ";
+        projection += table.get_columns()[index].get_name();
+    }
+    std::vector<std::string> lines{"Project: " + projection};
+    describe_scan(lines, table, plan.table_name, plan.where);
+    return lines;
+}
+
+std::vector<std::string> describe(const BoundInsert& plan, const db::Database& db) {
+    const auto& table = *db.get_table(plan.table_name);
+    std::vector<std::string> lines{"Insert on " + plan.table_name};
+    lines.push_back("  -> Values (rows=" + std::to_string(plan.rows.size()) + ")");
+    std::vector<size_t> all_columns(table.get_columns().size());
+    for (size_t i = 0; i < all_columns.size(); ++i) all_columns[i] = i;
+    describe_referenced(lines, table, all_columns);
+    return lines;
+}
+
+std::vector<std::string> describe(const BoundUpdate& plan, const db::Database& db) {
+    const auto& table = *db.get_table(plan.table_name);
+    const auto& columns = table.get_columns();
+    std::vector<std::string> lines{"Update on " + plan.table_name};
+    std::string set;
+    std::vector<size_t> set_columns;
+    for (const auto& [index, value] : plan.set) {
+        if (!set.empty()) set += ", ";
+        set += columns[index].get_name() + " = " + format_value(value);
+        set_columns.push_back(index);
+    }
+    lines.push_back("  Set: " + set);
+    describe_referenced(lines, table, set_columns);
+    for (size_t index : set_columns) describe_referencing(lines, db, plan.table_name, false, columns[index].get_name());
+    describe_scan(lines, table, plan.table_name, plan.where);
+    return lines;
+}
+
+std::vector<std::string> describe(const BoundDelete& plan, const db::Database& db) {
+    const auto& table = *db.get_table(plan.table_name);
+    std::vector<std::string> lines{"Delete on " + plan.table_name};
+    describe_referencing(lines, db, plan.table_name, true);
+    describe_scan(lines, table, plan.table_name, plan.where);
+    return lines;
+}
+
+std::string describe_operator(const OperatorStats& op) {
+    std::string line = op.name;
+    if (!op.detail.empty()) line += " on " + op.detail;
+    line += " (rows in=" + std::to_string(op.rows_in) + " out=" + std::to_string(op.rows_out);
+    if (op.blocks > 0) {
+        line += ", blocks=" + std::to_string(op.blocks) + " skipped=" + std::to_string(op.blocks_skipped);
+    }
+    line += ", memory=" + std::to_string(op.bytes_allocated) + " B, time=" + format_ms(op.elapsed) + ")";
+    return line;
+}
+
+ExecResult make_plan_result(const std::vector<std::string>& lines) {
+    ResultSet result_set;
+    result_set.add_column("QUERY PLAN", "STR");
+    for (const auto& line : lines) result_set.append_value(0, line);
+    return {true, "", "", std::move(result_set)};
+}
+
+ExecResult explain_plan(const ParseResult& statement, db::StorageEngine& engine, Session& session) {
+    if (session.current_db.empty()) return {false, "No database selected", ""};
+
+    // Внутри транзакции каталог уже удерживается с BEGIN
+    std::shared_lock<db::RwLock> catalog;
+    if (!session.transaction) {
+        catalog = std::shared_lock(engine.get_catalog_lock(), db::RwLock::Clock::now() + StatementLocks::kLockTimeout);
+        if (!catalog.owns_lock()) return {false, "Lock wait timeout exceeded", ""};
+    }
+
+    const auto* db = engine.get_database(session.current_db);
+    if (!db) return {false, "Database not found", ""};
+
+    BoundStatement plan;
+    Binder binder(*db, false);
+    if (!binder.bind(statement, plan)) return {false, binder.get_error(), ""};
+    return make_plan_result(std::visit([&](const auto& bound) { return describe(bound, *db); }, plan));
+}
+
+// Оператор выполняется по-настоящему, изменения фиксируются как обычно
+ExecResult explain_analyze(const ParseResult& statement, db::StorageEngine& engine, Session& session) {
+    Profiler profiler;
+    const auto started = std::chrono::steady_clock::now();
+    auto res = Executor::execute(statement, engine, session);
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    if (!res.ok) return res;
+
+    std::vector<std::string> lines;
+    for (const auto& op : profiler.get_operators()) lines.push_back(describe_operator(op));
+    if (res.result_set.column_count() > 0) {
+        lines.push_back("Result: " + std::to_string(res.result_set.row_count()) + " row(s)");
+    } else if (!res.result.empty()) {
+        lines.push_back("Result: " + res.result);
+    }
+    lines.push_back("Execution Time: " + format_ms(elapsed));
+    return make_plan_result(lines);
+}
+}
+
+ExecResult execute_explain(const Explain& cmd, db::StorageEngine& engine, Session& session) {
+    if (cmd.analyze) return explain_analyze(*cmd.statement, engine, session);
+    return explain_plan(*cmd.statement, engine, session);
+}
+
+}
+}
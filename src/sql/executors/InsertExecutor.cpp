@@ -1,97 +1,65 @@
 #include "sql/executors/InsertExecutor.hpp"
+#include "sql/executors/Constraints.hpp"
+#include "sql/Binder.hpp"
+#include "sql/Profiler.hpp"
+#include "sql/QueryArena.hpp"
 #include "db/ValueUtils.hpp"
-#include "sql/parsers/Utils.hpp"
 #include <algorithm>
 
 namespace sql {
 namespace executors {
 
-namespace {
-bool validate_type(const db::Value& value, const std::string& expected_type) {
-    if (std::holds_alternative<db::NullValue>(value)) return true;
-    
-    if (expected_type == "INT") return std::holds_alternative<int>(value);
-    if (expected_type == "FLOAT") return std::holds_alternative<float>(value);
-    if (expected_type == "BOOL") return std::holds_alternative<bool>(value);
-    if (expected_type == "STR") return std::holds_alternative<std::string>(value);
-    return false;
-}
-}
-
-ExecResult execute_insert(const Insert& cmd, db::StorageEngine& engine, const std::string& current_db) {
+ExecResult execute_insert(const Insert& cmd, db::StorageEngine& engine, const std::string& current_db, const db::StatementVersion& version) {
     if (current_db.empty()) return {false, "No database selected", ""};
     
     auto* db = engine.get_database(current_db);
     if (!db) return {false, "Database not found", ""};
-    
-    auto* table = db->get_table(cmd.table_name);
-    if (!table) return {false, "Table not found", ""};
 
-    std::vector<const db::Column*> target_columns;
-    const auto& columns = table->get_columns();
-    if (!cmd.columns.empty()) {
-        if (cmd.columns.size() != cmd.values.size())
-            return {false, "Column count doesn't match value count", ""};
-        for (const auto& col_name : cmd.columns) {
-            auto it = std::find_if(columns.begin(), columns.end(),
-                [&](const db::Column& col) { return col.get_name() == col_name; });
-            if (it == columns.end())
-                return {false, "Column '" + col_name + "' not found in table", ""};
-            target_columns.push_back(&(*it));
-        }
-    } else {
-        if (cmd.values.size() != columns.size())
-            return {false, "Value count doesn't match column count", ""};
-        for (const auto& col : columns)
-            target_columns.push_back(&col);
-    }
+    BoundInsert plan;
+    Binder binder(*db, false);
+    if (!binder.bind_insert(cmd, plan)) return {false, binder.get_error(), ""};
+    return run_insert(plan, *db, {}, version);
+}
+
+ExecResult run_insert(const BoundInsert& plan, db::Database& db, const std::vector<db::Value>& params, const db::StatementVersion& version) {
+    auto* table = db.get_table(plan.table_name);
+    if (!table) return {false, "Table not found", ""};
 
-    for (size_t i = 0; i < target_columns.size(); ++i) {
-        const db::Value& value = cmd.values[i];
-        const std::string& expected_type = target_columns[i]->get_type();
-        if (!validate_type(value, expected_type)) {
-            return {false, "Type mismatch for column '" + target_columns[i]->get_name() +
-                           "': expected " + expected_type + ", got value '" + db::value_to_string(value) + "'", ""};
+    // Список строк временный, а значения строк переходят в таблицу и выделяются в куче
+    const size_t column_count = table->get_columns().size();
+    std::pmr::vector<db::Row> new_rows(QueryArena::current());
+    {
+        OperatorScope values_scope("Values");
+        new_rows.reserve(plan.rows.size());
+        for (const auto& values : plan.rows) {
+            std::vector<db::Value> row_values(column_count, db::NullValue{});
+            for (size_t i = 0; i < plan.target_columns.size(); ++i) {
+                row_values[plan.target_columns[i]] = values[i].resolve(params);
+            }
+            new_rows.emplace_back(std::move(row_values));
         }
+        values_scope.add_rows_out(new_rows.size());
     }
 
-    for (size_t i = 0; i < target_columns.size(); ++i) {
-        const auto& column = *target_columns[i];
-        const auto& value = cmd.values[i];
-        
-        if (std::holds_alternative<db::NullValue>(value)) {
-            continue;
+    {
+        OperatorScope fk_check("FK Check");
+        fk_check.add_rows_in(new_rows.size());
+        std::string error;
+        if (!check_foreign_keys(db, *table, new_rows, error)) {
+            return {false, error, ""};
         }
-        
-        for (const auto& fk : column.get_foreign_keys()) {
-            const auto* ref_table = db->get_table(fk.referenced_table);
-            if (!ref_table) {
-                return {false, "Referenced table '" + fk.referenced_table + "' not found for foreign key constraint", ""};
-            }
-            
-            bool value_exists = false;
-            for (const auto& row : ref_table->get_rows()) {
-                const auto& row_values = row.get_values();
-                for (size_t j = 0; j < ref_table->get_columns().size(); ++j) {
-                    if (ref_table->get_columns()[j].get_name() == fk.referenced_column) {
-                        if (j < row_values.size() && db::value_equals(row_values[j], value)) {
-                            value_exists = true;
-                            break;
-                        }
-                    }
-                }
-                if (value_exists) break;
-            }
-            
-            if (!value_exists) {
-                return {false, "Foreign key constraint violation: value '" + db::value_to_string(value) + 
-                               "' does not exist in referenced table '" + fk.referenced_table + 
-                               "' column '" + fk.referenced_column + "'", ""};
-            }
+        // У предела памяти сначала убираются мертвые версии таблицы
+        if (!check_memory_limit(new_rows, error) &&
+            (!version.transaction->reclaim(*table) || !check_memory_limit(new_rows, error))) {
+            return {false, error, ""};
         }
+        fk_check.add_rows_out(new_rows.size());
     }
 
-    table->insert(db::Row(cmd.values));
+    OperatorScope write("Insert", plan.table_name);
+    write.add_rows_in(new_rows.size());
+    write.add_rows_out(new_rows.size());
+    version.transaction->insert_rows(db.get_name(), *table, new_rows);
     return {true, "", ""};
 }
 
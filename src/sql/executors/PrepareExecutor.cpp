@@ -0,0 +1,102 @@
+#include "sql/executors/PrepareExecutor.hpp"
+#include "sql/executors/SelectExecutor.hpp"
+#include "sql/executors/InsertExecutor.hpp"
+#include "sql/executors/UpdateExecutor.hpp"
+#include "sql/executors/DeleteExecutor.hpp"
+#include "sql/Binder.hpp"
+#include "sql/Parser.hpp"
+#include "db/ValueUtils.hpp"
+
+namespace sql {
+namespace executors {
+
+namespace {
+ExecResult bind_prepared(PreparedStatement& stmt, const db::StorageEngine& engine, const std::string& current_db) {
+    if (current_db.empty()) return {false, "No database selected", ""};
+
+    const auto* db = engine.get_database(current_db);
+    if (!db) return {false, "Database not found", ""};
+
+    Binder binder(*db, true);
+    BoundStatement plan;
+    if (!binder.bind(stmt.parsed, plan)) return {false, binder.get_error(), ""};
+
+    std::vector<ColumnType> param_types;
+    for (const auto& type : binder.get_param_types()) {
+        if (!type) return {false, "Parameter $" + std::to_string(param_types.size() + 1) + " is not used", ""};
+        param_types.push_back(*type);
+    }
+
+    stmt.plan = std::move(plan);
+    stmt.param_types = std::move(param_types);
+    stmt.db_name = current_db;
+    stmt.schema_version = engine.get_schema_version();
+    return {true, "", ""};
+}
+}
+
+ExecResult execute_prepare(const Prepare& cmd, db::StorageEngine& engine, const std::string& current_db, PreparedStatements& prepared) {
+    PreparedStatement stmt;
+    stmt.query = cmd.query;
+    stmt.parsed = Parser::parse(cmd.query);
+    if (!stmt.parsed.valid) return {false, "Parse error: " + stmt.parsed.error, ""};
+
+    auto res = bind_prepared(stmt, engine, current_db);
+    if (!res.ok) return res;
+
+    prepared[cmd.name] = std::move(stmt);
+    return {true, "", ""};
+}
+
+ExecResult execute_execute(const Execute& cmd, db::StorageEngine& engine, const std::string& current_db, PreparedStatements& prepared, const db::StatementVersion& version) {
+    auto it = prepared.find(cmd.name);
+    if (it == prepared.end()) return {false, "Prepared statement '" + cmd.name + "' not found", ""};
+    auto& stmt = it->second;
+
+    // После CREATE/DROP или смены базы план связывается заново
+    if (stmt.db_name != current_db || stmt.schema_version != engine.get_schema_version()) {
+        auto res = bind_prepared(stmt, engine, current_db);
+        if (!res.ok) return res;
+    }
+
+    if (cmd.params.size() != stmt.param_types.size()) {
+        return {false, "Expected " + std::to_string(stmt.param_types.size()) + " parameter(s), got " +
+                       std::to_string(cmd.params.size()), ""};
+    }
+
+    std::vector<db::Value> params = cmd.params;
+    for (size_t i = 0; i < params.size(); ++i) {
+        const ColumnType type = stmt.param_types[i];
+        if (type == ColumnType::FLOAT && std::holds_alternative<int>(params[i])) {
+            params[i] = static_cast<float>(std::get<int>(params[i]));
+        }
+        if (!value_matches_type(params[i], type)) {
+            return {false, "Type mismatch for parameter $" + std::to_string(i + 1) + ": expected " + column_type_name(type) +
+                           ", got value '" + db::value_to_string(params[i]) + "'", ""};
+        }
+    }
+
+    auto* db = engine.get_database(current_db);
+    if (!db) return {false, "Database not found", ""};
+
+    return std::visit([&](const auto& plan) -> ExecResult {
+        using T = std::decay_t<decltype(plan)>;
+        if constexpr (std::is_same_v<T, BoundSelect>) {
+            return run_select(plan, *db, params, version);
+        } else if constexpr (std::is_same_v<T, BoundInsert>) {
+            return run_insert(plan, *db, params, version);
+        } else if constexpr (std::is_same_v<T, BoundUpdate>) {
+            return run_update(plan, *db, params, version);
+        } else {
+            return run_delete(plan, *db, params, version);
+        }
+    }, stmt.plan);
+}
+
+ExecResult execute_deallocate(const Deallocate& cmd, PreparedStatements& prepared) {
+    if (!prepared.erase(cmd.name)) return {false, "Prepared statement '" + cmd.name + "' not found", ""};
+    return {true, "", ""};
+}
+
+}
+}
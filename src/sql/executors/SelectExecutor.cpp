@@ -1,70 +1,60 @@
 #include "sql/executors/SelectExecutor.hpp"
+#include "sql/Binder.hpp"
+#include "sql/QueryArena.hpp"
+#include "sql/Profiler.hpp"
 #include "db/ValueUtils.hpp"
-#include "sql/parsers/Utils.hpp"
 #include <algorithm>
 
 namespace sql {
 namespace executors {
 
-ExecResult execute_select(const Select& cmd, db::StorageEngine& engine, const std::string& current_db) {
+ExecResult execute_select(const Select& cmd, db::StorageEngine& engine, const std::string& current_db, const db::StatementVersion& version) {
     if (current_db.empty()) return {false, "No database selected", ""};
     
     auto* db = engine.get_database(current_db);
     if (!db) return {false, "Database not found", ""};
-    
-    auto* table = db->get_table(cmd.table_name);
+
+    BoundSelect plan;
+    Binder binder(*db, false);
+    if (!binder.bind_select(cmd, plan)) return {false, binder.get_error(), ""};
+    return run_select(plan, *db, {}, version);
+}
+
+ExecResult run_select(const BoundSelect& plan, db::Database& db, const std::vector<db::Value>& params, const db::StatementVersion& version) {
+    auto* table = db.get_table(plan.table_name);
     if (!table) return {false, "Table not found", ""};
 
     const auto& columns = table->get_columns();
-    std::vector<const db::Column*> selected_columns;
-    
-    if (cmd.columns.size() == 1 && cmd.columns[0] == "*") {
-        for (const auto& col : columns) {
-            selected_columns.push_back(&col);
-        }
-    } else {
-        for (const auto& col_name : cmd.columns) {
-            auto it = std::find_if(columns.begin(), columns.end(),
-                [&](const db::Column& col) { return col.get_name() == col_name; });
-            if (it == columns.end())
-                return {false, "Column '" + col_name + "' not found in table", ""};
-            selected_columns.push_back(&(*it));
-        }
+    ResultSet result_set;
+    for (size_t index : plan.columns) {
+        result_set.add_column(columns[index].get_name(), columns[index].get_type());
     }
 
-    std::string result = "";
-    for (size_t i = 0; i < selected_columns.size(); ++i) {
-        if (i > 0) result += " | ";
-        result += selected_columns[i]->get_name();
-    }
-    result += "\n";
-    
-    for (size_t i = 0; i < selected_columns.size(); ++i) {
-        if (i > 0) result += "-+-";
-        for (size_t j = 0; j < selected_columns[i]->get_name().length(); ++j) {
-            result += "-";
+    auto rows = table->scan();
+    std::pmr::vector<const db::Row*> matched(QueryArena::current());
+    {
+        OperatorScope scan("Seq Scan", plan.table_name);
+        matched.reserve(static_cast<size_t>(plan.where.selectivity * static_cast<double>(rows.size())));
+        for (const auto& row : rows) {
+            if (version.is_visible(row) && matches(plan.where, row, params)) matched.push_back(&row);
         }
+        scan.add_blocks(rows.chunk_count());
+        scan.add_rows_in(rows.size());
+        scan.add_rows_out(matched.size());
     }
-    result += "\n";
 
-    const auto& rows = table->get_rows();
-    for (const auto& row : rows) {
-        const auto& row_values = row.get_values();
-        for (size_t i = 0; i < selected_columns.size(); ++i) {
-            if (i > 0) result += " | ";
-            size_t col_index = 0;
-            for (size_t j = 0; j < columns.size(); ++j) {
-                if (columns[j].get_name() == selected_columns[i]->get_name()) {
-                    col_index = j;
-                    break;
-                }
-            }
-            result += db::value_to_string(row_values[col_index]);
+    OperatorScope project("Project");
+    result_set.reserve(matched.size());
+    for (size_t i = 0; i < plan.columns.size(); ++i) {
+        const size_t col_index = plan.columns[i];
+        for (const auto* row : matched) {
+            result_set.append_value(i, row->get_values()[col_index]);
         }
-        result += "\n";
     }
+    project.add_rows_in(matched.size());
+    project.add_rows_out(matched.size());
 
-    return {true, "", result};
+    return {true, "", "", std::move(result_set), rows.size()};
 }
 
 }
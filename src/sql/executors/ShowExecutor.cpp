@@ -0,0 +1,177 @@
+#include "sql/executors/ShowExecutor.hpp"
+#include "metrics/Metrics.hpp"
+#include "metrics/SlowLog.hpp"
+#include "sql/StatementLocks.hpp"
+#include "sql/ResultCache.hpp"
+#include "db/MemoryTracker.hpp"
+#include <mutex>
+#include <shared_mutex>
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+
+namespace sql {
+namespace executors {
+
+namespace {
+std::string_view command_name(CommandType type) {
+    switch (type) {
+    case CommandType::CREATE_DATABASE: return "create_database";
+    case CommandType::DROP_DATABASE: return "drop_database";
+    case CommandType::CREATE_TABLE: return "create_table";
+    case CommandType::DROP_TABLE: return "drop_table";
+    case CommandType::INSERT: return "insert";
+    case CommandType::SELECT: return "select";
+    case CommandType::UPDATE: return "update";
+    case CommandType::DELETE: return "delete";
+    case CommandType::USE: return "use";
+    case CommandType::COPY: return "copy";
+    case CommandType::PREPARE: return "prepare";
+    case CommandType::EXECUTE: return "execute";
+    case CommandType::DEALLOCATE: return "deallocate";
+    case CommandType::BEGIN: return "begin";
+    case CommandType::COMMIT: return "commit";
+    case CommandType::ROLLBACK: return "rollback";
+    case CommandType::SHOW: return "show";
+    case CommandType::EXPLAIN: return "explain";
+    case CommandType::ANALYZE: return "analyze";
+    case CommandType::UNKNOWN: return "unknown";
+    }
+    return "unknown";
+}
+
+// Внутри транзакции каталог уже удерживается сессией с BEGIN
+std::shared_lock<db::RwLock> lock_catalog(const db::StorageEngine& engine, bool held) {
+    if (held) return {};
+    return std::shared_lock(engine.get_catalog_lock(), db::RwLock::Clock::now() + StatementLocks::kLockTimeout);
+}
+
+void add_latency(std::vector<MetricLine>& lines, const std::string& prefix, const metrics::Histogram& h) {
+    lines.push_back({prefix + "_p50_us", std::to_string(h.percentile(50))});
+    lines.push_back({prefix + "_p99_us", std::to_string(h.percentile(99))});
+    lines.push_back({prefix + "_p999_us", std::to_string(h.percentile(99.9))});
+    lines.push_back({prefix + "_max_us", std::to_string(h.max())});
+}
+}
+
+std::vector<TableMemoryLine> collect_table_memory(const db::StorageEngine& engine) {
+    std::vector<TableMemoryLine> lines;
+    for (const auto& [db_name, database] : engine.get_databases()) {
+        for (const auto& [table_name, table] : database.get_tables()) {
+            lines.push_back({db_name, table_name, table.get_memory()});
+        }
+    }
+    std::sort(lines.begin(), lines.end(), [](const TableMemoryLine& a, const TableMemoryLine& b) {
+        return std::tie(a.database, a.table) < std::tie(b.database, b.table);
+    });
+    return lines;
+}
+
+std::vector<MetricLine> collect_metrics(const db::StorageEngine& engine, bool catalog_held) {
+    std::vector<MetricLine> lines;
+    const auto server = metrics::collect_server();
+    lines.push_back({"connections_active", std::to_string(server.connections_opened - server.connections_closed)});
+    lines.push_back({"connections_total", std::to_string(server.connections_opened)});
+    lines.push_back({"bytes_received", std::to_string(server.bytes_received)});
+    lines.push_back({"bytes_sent", std::to_string(server.bytes_sent)});
+    lines.push_back({"slow_queries_dropped", std::to_string(metrics::slow_queries_dropped())});
+    lines.push_back({"memory_used_bytes", std::to_string(db::MemoryTracker::used())});
+    lines.push_back({"memory_limit_bytes", std::to_string(db::MemoryTracker::limit())});
+    if (ResultCache::enabled()) {
+        const auto cache = ResultCache::stats();
+        lines.push_back({"result_cache_hits", std::to_string(cache.hits)});
+        lines.push_back({"result_cache_misses", std::to_string(cache.misses)});
+        lines.push_back({"result_cache_evictions", std::to_string(cache.evictions)});
+        lines.push_back({"result_cache_entries", std::to_string(cache.entries)});
+        lines.push_back({"result_cache_bytes", std::to_string(cache.bytes)});
+    }
+    if (auto catalog = lock_catalog(engine, catalog_held); catalog_held || catalog.owns_lock()) {
+        for (const auto& line : collect_table_memory(engine)) {
+            const std::string prefix = "memory." + line.database + "." + line.table;
+            lines.push_back({prefix + ".rows_bytes", std::to_string(line.memory.rows)});
+            lines.push_back({prefix + ".strings_bytes", std::to_string(line.memory.strings)});
+            lines.push_back({prefix + ".dead_bytes", std::to_string(line.memory.dead)});
+        }
+    }
+
+    const auto statements = metrics::collect_statements();
+    for (size_t kind = 0; kind <= static_cast<size_t>(CommandType::UNKNOWN); ++kind) {
+        const auto& stats = statements[kind];
+        if (stats.calls == 0) continue;
+
+        const std::string name(command_name(static_cast<CommandType>(kind)));
+        lines.push_back({name + ".calls", std::to_string(stats.calls)});
+        lines.push_back({name + ".errors", std::to_string(stats.errors)});
+        lines.push_back({name + ".rows_scanned", std::to_string(stats.rows_scanned)});
+        lines.push_back({name + ".rows_returned", std::to_string(stats.rows_returned)});
+        add_latency(lines, name + ".parse", stats.parse_us);
+        add_latency(lines, name + ".execute", stats.execute_us);
+    }
+    return lines;
+}
+
+ExecResult execute_show(const Show& cmd, const db::StorageEngine& engine, const Session& session) {
+    const bool catalog_held = session.transaction != nullptr;
+    ResultSet result_set;
+    switch (cmd.target) {
+    case ShowTarget::STATS:
+        result_set.add_column("metric", "STR");
+        result_set.add_column("value", "STR");
+        for (auto& line : collect_metrics(engine, catalog_held)) {
+            result_set.append_value(0, std::move(line.name));
+            result_set.append_value(1, std::move(line.value));
+        }
+        break;
+    case ShowTarget::TOP_QUERIES:
+        // Сводка по медленным запросам, по убыванию суммарного времени
+        result_set.add_column("fingerprint", "STR");
+        result_set.add_column("calls", "INT");
+        result_set.add_column("errors", "INT");
+        result_set.add_column("total_ms", "FLOAT");
+        result_set.add_column("mean_ms", "FLOAT");
+        result_set.add_column("max_ms", "FLOAT");
+        result_set.add_column("rows_scanned", "INT");
+        for (auto& entry : metrics::top_queries(cmd.limit)) {
+            result_set.append_value(0, std::move(entry.fingerprint));
+            result_set.append_value(1, static_cast<int>(entry.calls));
+            result_set.append_value(2, static_cast<int>(entry.errors));
+            result_set.append_value(3, static_cast<float>(entry.total_us / 1000.0));
+            result_set.append_value(4, static_cast<float>(entry.total_us / 1000.0 / static_cast<double>(entry.calls)));
+            result_set.append_value(5, static_cast<float>(entry.max_us / 1000.0));
+            result_set.append_value(6, static_cast<int>(entry.rows_scanned));
+        }
+        break;
+    case ShowTarget::MEMORY: {
+        // Байты выводятся строками, как в SHOW STATS: INT не вмещает большие значения
+        auto catalog = lock_catalog(engine, catalog_held);
+        if (!catalog_held && !catalog.owns_lock()) return {false, "Lock wait timeout exceeded", ""};
+        result_set.add_column("database", "STR");
+        result_set.add_column("table", "STR");
+        result_set.add_column("rows_bytes", "STR");
+        result_set.add_column("strings_bytes", "STR");
+        result_set.add_column("dead_bytes", "STR");
+        result_set.add_column("total_bytes", "STR");
+        auto add_row = [&](std::string database, std::string table, const db::TableMemory& memory) {
+            result_set.append_value(0, std::move(database));
+            result_set.append_value(1, std::move(table));
+            result_set.append_value(2, std::to_string(memory.rows));
+            result_set.append_value(3, std::to_string(memory.strings));
+            result_set.append_value(4, std::to_string(memory.dead));
+            result_set.append_value(5, std::to_string(memory.total()));
+        };
+        db::TableMemory total;
+        for (auto& line : collect_table_memory(engine)) {
+            total.rows += line.memory.rows;
+            total.strings += line.memory.strings;
+            total.dead += line.memory.dead;
+            add_row(std::move(line.database), std::move(line.table), line.memory);
+        }
+        add_row("*", "*", total);
+        break;
+    }
+    }
+    return {true, "", "", std::move(result_set)};
+}
+
+}
+}
@@ -0,0 +1,39 @@
+#include "sql/executors/TransactionExecutor.hpp"
+
+namespace sql {
+namespace executors {
+
+ExecResult execute_begin(db::StorageEngine& engine, std::unique_ptr<db::Transaction>& transaction) {
+    if (transaction) return {false, "Transaction already in progress", ""};
+
+    // Каталог удерживается до конца транзакции: CREATE/DROP ждут ее завершения
+    auto started = std::make_unique<db::Transaction>(engine.get_versions());
+    started->hold_catalog(engine.get_catalog_lock());
+    transaction = std::move(started);
+    return {true, "", ""};
+}
+
+ExecResult execute_commit(db::StorageEngine& engine, std::unique_ptr<db::Transaction>& transaction,
+                          bool defer_durability) {
+    if (!transaction) return {false, "No transaction in progress", ""};
+
+    auto committing = std::move(transaction);
+    std::string error;
+    ExecResult result{true, "", ""};
+    if (!committing->commit(engine.get_wal(), error, defer_durability ? &result.pending_commit : nullptr)) {
+        if (error == db::kUnknownCommitOutcome) return {false, error, ""};
+        return {false, error + ", transaction rolled back", ""};
+    }
+    return result;
+}
+
+ExecResult execute_rollback(std::unique_ptr<db::Transaction>& transaction) {
+    if (!transaction) return {false, "No transaction in progress", ""};
+
+    transaction->rollback();
+    transaction.reset();
+    return {true, "", ""};
+}
+
+}
+}
@@ -0,0 +1,22 @@
+#include "sql/parsers/AnalyzeParser.hpp"
+#include "sql/parsers/Utils.hpp"
+#include <string>
+#include <sstream>
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_analyze(std::istringstream& iss) {
+    Analyze analyze;
+    std::string word;
+    if (iss >> word) {
+        if (!word.empty() && word.back() == ';') word.pop_back();
+        analyze.table_name = word;
+    }
+    std::string extra;
+    if (iss >> extra && extra != ";") return {CommandType::ANALYZE, {}, false, "Unexpected token: " + extra};
+    return {CommandType::ANALYZE, analyze, true, ""};
+}
+
+}
+}
@@ -0,0 +1,54 @@
+#include "sql/parsers/CopyParser.hpp"
+#include "sql/parsers/Utils.hpp"
+#include <string>
+#include <sstream>
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_copy(std::istringstream& iss) {
+    std::string tablename;
+    iss >> tablename;
+    if (tablename.empty()) return {CommandType::COPY, {}, false, "No table name"};
+
+    std::string direction;
+    iss >> direction;
+    direction = to_upper(direction);
+    if (direction != "FROM" && direction != "TO")
+        return {CommandType::COPY, {}, false, "Expected FROM or TO"};
+
+    char quote;
+    if (!(iss >> quote) || (quote != '\'' && quote != '"'))
+        return {CommandType::COPY, {}, false, "Expected quoted file path"};
+
+    std::string path;
+    char c;
+    bool closed = false;
+    while (iss.get(c)) {
+        if (c == quote) {
+            closed = true;
+            break;
+        }
+        path += c;
+    }
+    if (!closed) return {CommandType::COPY, {}, false, "Unterminated file path"};
+    if (path.empty()) return {CommandType::COPY, {}, false, "Empty file path"};
+
+    bool header = false;
+    std::string word;
+    while (iss >> word) {
+        if (word.back() == ';') word.pop_back();
+        word = to_upper(word);
+        if (word.empty() || word == "WITH") continue;
+        if (word == "HEADER") {
+            header = true;
+            continue;
+        }
+        return {CommandType::COPY, {}, false, "Unexpected option: " + word};
+    }
+
+    return {CommandType::COPY, Copy{tablename, path, direction == "FROM", header}, true, ""};
+}
+
+}
+}
@@ -8,6 +8,40 @@
 namespace sql {
 namespace parsers {
 
+namespace {
+// Разбирает [ON DELETE действие] [ON UPDATE действие] после FK таблица(колонка)
+bool parse_fk_actions(const std::vector<std::string>& tokens, size_t pos, ForeignKeyConstraint& fk, std::string& error) {
+    while (pos < tokens.size()) {
+        if (to_upper(tokens[pos]) != "ON" || pos + 2 >= tokens.size()) {
+            error = "Invalid FK syntax near '" + tokens[pos] + "', expected ON DELETE or ON UPDATE";
+            return false;
+        }
+        const std::string event = to_upper(tokens[pos + 1]);
+        db::ForeignKeyAction* target = event == "DELETE" ? &fk.on_delete : event == "UPDATE" ? &fk.on_update : nullptr;
+        if (!target) {
+            error = "Invalid FK syntax: expected DELETE or UPDATE after ON, got '" + tokens[pos + 1] + "'";
+            return false;
+        }
+
+        const std::string action = to_upper(tokens[pos + 2]);
+        pos += 3;
+        if (action == "CASCADE") {
+            *target = db::ForeignKeyAction::CASCADE;
+        } else if (action == "RESTRICT") {
+            *target = db::ForeignKeyAction::RESTRICT;
+        } else if ((action == "SET" || action == "NO") && pos < tokens.size() &&
+                   to_upper(tokens[pos]) == (action == "SET" ? "NULL" : "ACTION")) {
+            *target = action == "SET" ? db::ForeignKeyAction::SET_NULL : db::ForeignKeyAction::RESTRICT;
+            ++pos;
+        } else {
+            error = "Invalid FK action: '" + tokens[pos - 1] + "'. Supported actions: CASCADE, SET NULL, RESTRICT";
+            return false;
+        }
+    }
+    return true;
+}
+}
+
 ParseResult parse_create_database(std::istringstream& iss) {
     std::string dbname;
     iss >> dbname;
@@ -142,7 +176,12 @@ ParseResult parse_create_table(std::istringstream& iss) {
             std::string ref_column = ref_part.substr(paren_pos + 1);
             ref_column.pop_back();
             
-            foreign_keys.emplace_back(fk_column, ref_table, ref_column);
+            ForeignKeyConstraint fk(fk_column, ref_table, ref_column);
+            std::string error;
+            if (!parse_fk_actions(tokens, fk_index + 2, fk, error)) {
+                return {CommandType::CREATE_TABLE, {}, false, error};
+            }
+            foreign_keys.push_back(std::move(fk));
             continue;
         }
         
@@ -0,0 +1,43 @@
+#include "sql/parsers/ExplainParser.hpp"
+#include "sql/parsers/Utils.hpp"
+#include "sql/Parser.hpp"
+#include <memory>
+#include <string>
+#include <sstream>
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_explain(std::istringstream& iss) {
+    Explain explain;
+    const auto start = iss.tellg();
+    std::string word;
+    if (!(iss >> word)) return {CommandType::EXPLAIN, {}, false, "Expected statement after EXPLAIN"};
+    if (to_upper(word) == "ANALYZE") {
+        explain.analyze = true;
+    } else {
+        iss.clear();
+        iss.seekg(start);
+    }
+
+    std::string rest;
+    std::getline(iss, rest, '\0');
+    auto statement = std::make_shared<ParseResult>(Parser::parse(rest));
+    if (!statement->valid) return {CommandType::EXPLAIN, {}, false, statement->error};
+
+    switch (statement->type) {
+    case CommandType::SELECT:
+    case CommandType::INSERT:
+    case CommandType::UPDATE:
+    case CommandType::DELETE:
+        break;
+    default:
+        return {CommandType::EXPLAIN, {}, false, "EXPLAIN supports only SELECT, INSERT, UPDATE and DELETE"};
+    }
+
+    explain.statement = std::move(statement);
+    return {CommandType::EXPLAIN, std::move(explain), true, ""};
+}
+
+}
+}
@@ -41,24 +41,23 @@ ParseResult parse_insert(std::istringstream& iss) {
     word = to_upper(word);
     if (word != "VALUES") return {CommandType::INSERT, {}, false, "Expected VALUES"};
     
-    iss >> c;
-    if (c != '(') return {CommandType::INSERT, {}, false, "Expected '(' after VALUES"};
-    
-    std::vector<db::Value> values;
-    std::string val;
-    while (iss >> val) {
-        while (!val.empty() && (val.back() == ',' || val.back() == ';' || val.back() == ')')) {
-            val.pop_back();
-        }
-        values.push_back(parse_value(val));
-        char peek = iss.peek();
-        if (peek == ')' || peek == ';') {
-            iss.get();
-            break;
+    std::vector<std::vector<db::Value>> rows;
+    std::vector<std::vector<bool>> quoted;
+    for (;;) {
+        std::vector<db::Value> values;
+        std::vector<bool> row_quoted;
+        std::string error;
+        if (!parse_value_tuple(iss, values, error, &row_quoted)) {
+            return {CommandType::INSERT, {}, false, error + " in VALUES"};
         }
+        rows.push_back(std::move(values));
+        quoted.push_back(std::move(row_quoted));
+
+        if (!(iss >> c) || c == ';') break;
+        if (c != ',') return {CommandType::INSERT, {}, false, "Expected ',' between VALUES tuples"};
     }
     
-    return {CommandType::INSERT, Insert{tablename, columns, values}, true, ""};
+    return {CommandType::INSERT, Insert{tablename, columns, std::move(rows), std::move(quoted)}, true, ""};
 }
 
 }
@@ -0,0 +1,77 @@
+#include "sql/parsers/PrepareParser.hpp"
+#include "sql/parsers/Utils.hpp"
+#include <string>
+#include <sstream>
+#include <cctype>
+
+namespace sql {
+namespace parsers {
+
+namespace {
+std::string read_name(std::istringstream& iss) {
+    std::string name;
+    char c;
+    iss >> std::ws;
+    while (iss.get(c)) {
+        if (std::isspace(static_cast<unsigned char>(c)) || c == '(' || c == ';') {
+            iss.unget();
+            break;
+        }
+        name += c;
+    }
+    return name;
+}
+}
+
+ParseResult parse_prepare(std::istringstream& iss) {
+    std::string name = read_name(iss);
+    if (name.empty()) return {CommandType::PREPARE, {}, false, "No statement name"};
+
+    std::string word;
+    iss >> word;
+    if (to_upper(word) != "AS") return {CommandType::PREPARE, {}, false, "Expected AS"};
+
+    std::string query;
+    std::getline(iss, query, '\0');
+    query.erase(0, query.find_first_not_of(" \t\r\n"));
+    query.erase(query.find_last_not_of(" \t\r\n") + 1);
+    if (query.empty()) return {CommandType::PREPARE, {}, false, "No statement to prepare"};
+
+    return {CommandType::PREPARE, Prepare{name, query}, true, ""};
+}
+
+ParseResult parse_execute(std::istringstream& iss) {
+    std::string name = read_name(iss);
+    if (name.empty()) return {CommandType::EXECUTE, {}, false, "No statement name"};
+
+    std::vector<db::Value> params;
+    iss >> std::ws;
+    if (iss.peek() == '(') {
+        auto start = iss.tellg();
+        iss.get();
+        iss >> std::ws;
+        if (iss.peek() == ')') {
+            iss.get();
+        } else {
+            iss.seekg(start);
+            std::string error;
+            if (!parse_value_tuple(iss, params, error)) {
+                return {CommandType::EXECUTE, {}, false, error + " in EXECUTE parameters"};
+            }
+        }
+    }
+
+    return {CommandType::EXECUTE, Execute{name, std::move(params)}, true, ""};
+}
+
+ParseResult parse_deallocate(std::istringstream& iss) {
+    std::string name;
+    iss >> name;
+    if (to_upper(name) == "PREPARE") iss >> name;
+    if (!name.empty() && name.back() == ';') name.pop_back();
+    if (name.empty()) return {CommandType::DEALLOCATE, {}, false, "No statement name"};
+    return {CommandType::DEALLOCATE, Deallocate{name}, true, ""};
+}
+
+}
+}
@@ -0,0 +1,47 @@
+#include "sql/parsers/ShowParser.hpp"
+#include "sql/parsers/Utils.hpp"
+#include <string>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace sql {
+namespace parsers {
+
+ParseResult parse_show(std::istringstream& iss) {
+    std::vector<std::string> words;
+    std::string word;
+    while (iss >> word) {
+        if (!word.empty() && word.back() == ';') word.pop_back();
+        if (!word.empty()) words.push_back(word);
+    }
+    if (words.empty()) return {CommandType::SHOW, {}, false, "Expected what to show"};
+
+    std::string upper = to_upper(words[0]);
+    if (upper == "STATS" || upper == "MEMORY") {
+        if (words.size() > 1) return {CommandType::SHOW, {}, false, "Unexpected token: " + words[1]};
+        return {CommandType::SHOW, Show{upper == "STATS" ? ShowTarget::STATS : ShowTarget::MEMORY}, true, ""};
+    }
+    if (upper == "TOP") {
+        if (words.size() < 2 || to_upper(words[1]) != "QUERIES") {
+            return {CommandType::SHOW, {}, false, "Expected QUERIES after TOP"};
+        }
+        Show show{ShowTarget::TOP_QUERIES};
+        if (words.size() > 2) {
+            try {
+                size_t pos = 0;
+                int limit = std::stoi(words[2], &pos);
+                if (pos != words[2].size() || limit <= 0) throw std::invalid_argument(words[2]);
+                show.limit = static_cast<size_t>(limit);
+            } catch (...) {
+                return {CommandType::SHOW, {}, false, "Invalid number of queries: " + words[2]};
+            }
+        }
+        if (words.size() > 3) return {CommandType::SHOW, {}, false, "Unexpected token: " + words[3]};
+        return {CommandType::SHOW, show, true, ""};
+    }
+    return {CommandType::SHOW, {}, false, "Unknown SHOW target: " + words[0]};
+}
+
+}
+}
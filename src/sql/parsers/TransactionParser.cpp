@@ -0,0 +1,51 @@
+#include "sql/parsers/TransactionParser.hpp"
+#include "sql/parsers/Utils.hpp"
+#include <string>
+#include <sstream>
+
+namespace sql {
+namespace parsers {
+
+namespace {
+// После ключевого слова допускается только TRANSACTION или WORK
+bool parse_tail(std::istringstream& iss, std::string& error) {
+    std::string rest;
+    std::getline(iss, rest, '\0');
+    std::istringstream tail(rest);
+    std::string word;
+    tail >> word;
+    if (!word.empty() && word.back() == ';') word.pop_back();
+    std::string upper = to_upper(word);
+    if (!upper.empty() && upper != "TRANSACTION" && upper != "WORK") {
+        error = "Unexpected token: " + word;
+        return false;
+    }
+    std::string extra;
+    if (tail >> extra && extra != ";") {
+        error = "Unexpected token: " + extra;
+        return false;
+    }
+    return true;
+}
+}
+
+ParseResult parse_begin(std::istringstream& iss) {
+    std::string error;
+    if (!parse_tail(iss, error)) return {CommandType::BEGIN, {}, false, error};
+    return {CommandType::BEGIN, Begin{}, true, ""};
+}
+
+ParseResult parse_commit(std::istringstream& iss) {
+    std::string error;
+    if (!parse_tail(iss, error)) return {CommandType::COMMIT, {}, false, error};
+    return {CommandType::COMMIT, Commit{}, true, ""};
+}
+
+ParseResult parse_rollback(std::istringstream& iss) {
+    std::string error;
+    if (!parse_tail(iss, error)) return {CommandType::ROLLBACK, {}, false, error};
+    return {CommandType::ROLLBACK, Rollback{}, true, ""};
+}
+
+}
+}
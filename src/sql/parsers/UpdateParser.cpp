@@ -49,24 +49,8 @@ ParseResult parse_update(std::istringstream& iss) {
         
         std::istringstream where_stream(where_part);
         std::string token;
-        std::vector<std::string> tokens;
-        
         while (where_stream >> token) {
-            tokens.push_back(token);
-        }
-        
-        for (size_t i = 0; i < tokens.size(); i += 3) {
-            if (i + 2 < tokens.size() && tokens[i + 1] == "=") {
-                where_clauses.push_back(tokens[i] + "=" + tokens[i + 2]);
-            }
-        }
-        
-        if (tokens.size() == 1) {
-            std::string condition = tokens[0];
-            size_t equals_pos = condition.find('=');
-            if (equals_pos != std::string::npos) {
-                where_clauses.push_back(condition);
-            }
+            where_clauses.push_back(token);
         }
     } else {
         set_part = line;
@@ -1,6 +1,8 @@
 #include "sql/parsers/Utils.hpp"
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <istream>
 
 namespace sql {
 namespace parsers {
@@ -11,32 +13,47 @@ std::string to_upper(const std::string& s) {
     return r;
 }
 
-db::Value parse_value(const std::string& val) {
-    std::string clean_val = val;
-    if (clean_val.size() >= 2 && clean_val.front() == '"' && clean_val.back() == '"') {
-        clean_val = clean_val.substr(1, clean_val.size() - 2);
-    }
-    
-    try {
-        int int_val = std::stoi(clean_val);
+bool equals_upper(std::string_view word, std::string_view upper) noexcept {
+    return word.size() == upper.size() && std::equal(word.begin(), word.end(), upper.begin(), [](char a, char b) {
+        return std::toupper(static_cast<unsigned char>(a)) == b;
+    });
+}
+
+bool is_quoted(std::string_view val) noexcept {
+    return val.size() >= 2 && val.front() == '"' && val.back() == '"';
+}
+
+db::Value parse_value(std::string_view val) {
+    // Кавычки отрезаются без копии: строка создается, только если значение - строка
+    const bool quoted = is_quoted(val);
+    std::string_view clean_val = quoted ? val.substr(1, val.size() - 2) : val;
+
+    const char* first = clean_val.data();
+    const char* last = clean_val.data() + clean_val.size();
+    if (first != last && *first == '+') ++first;
+
+    int int_val = 0;
+    auto int_res = std::from_chars(first, last, int_val);
+    if (int_res.ec == std::errc() && int_res.ptr == last) {
         return db::Value(int_val);
-    } catch (...) {}
+    }
     
-    try {
-        float float_val = std::stof(clean_val);
+    float float_val = 0;
+    auto float_res = std::from_chars(first, last, float_val);
+    if (float_res.ec == std::errc() && float_res.ptr == last) {
         return db::Value(float_val);
-    } catch (...) {}
+    }
     
-    std::string upper_val = to_upper(clean_val);
-    if (upper_val == "TRUE" || upper_val == "FALSE") {
-        return db::Value(upper_val == "TRUE");
+    if (equals_upper(clean_val, "TRUE") || equals_upper(clean_val, "FALSE")) {
+        return db::Value(equals_upper(clean_val, "TRUE"));
     }
     
-    if (upper_val == "NULL") {
+    // "NULL" в кавычках - обычная строка
+    if (!quoted && equals_upper(clean_val, "NULL")) {
         return db::Value(db::NullValue{});
     }
     
-    return db::Value(clean_val);
+    return db::Value(std::string(clean_val));
 }
 
 std::string value_to_string(const db::Value& value) {
@@ -54,5 +71,46 @@ std::string value_to_string(const db::Value& value) {
     return "unknown";
 }
 
+bool parse_value_tuple(std::istream& is, std::vector<db::Value>& values, std::string& error,
+                       std::vector<bool>* quoted) {
+    char c;
+    if (!(is >> c) || c != '(') {
+        error = "Expected '('";
+        return false;
+    }
+
+    std::string current;
+    bool in_quotes = false;
+    bool closed = false;
+    while (is.get(c)) {
+        if (c == '"') {
+            in_quotes = !in_quotes;
+            current += c;
+        } else if (!in_quotes && (c == ',' || c == ')')) {
+            current.erase(0, current.find_first_not_of(" \t\r\n"));
+            current.erase(current.find_last_not_of(" \t\r\n") + 1);
+            if (current.empty()) {
+                error = "Empty value in tuple";
+                return false;
+            }
+            values.push_back(parse_value(current));
+            if (quoted) quoted->push_back(is_quoted(current));
+            current.clear();
+            if (c == ')') {
+                closed = true;
+                break;
+            }
+        } else {
+            current += c;
+        }
+    }
+
+    if (!closed) {
+        error = in_quotes ? "Unterminated string literal" : "Expected ')'";
+        return false;
+    }
+    return true;
+}
+
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,445 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "sql/Parser.hpp"
+#include "sql/Executor.hpp"
+#include "sql/ScanKernels.hpp"
+#include "db/StorageEngineIO.hpp"
+#include "db/ValueUtils.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string filter;
+    double min_time = 0.5;
+    std::string out;
+};
+
+// Результат одного замера: время на итерацию и пропускная способность
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double real_time_ns = 0;
+    double cpu_time_ns = 0;
+    double items_per_second = 0;
+    double bytes_per_second = 0;
+};
+
+// Что обработала одна итерация; заполняется телом замера
+struct Work {
+    uint64_t items = 0;
+    uint64_t bytes = 0;
+};
+
+// Не дает компилятору выбросить результат измеряемого кода
+volatile uint64_t sink = 0;
+
+// Число итераций подбирается так, чтобы замер длился не меньше min_time,
+// как в Google Benchmark; формат JSON совместим с его compare.py.
+class Runner {
+public:
+    explicit Runner(Options options) : options_(std::move(options)) {}
+
+    bool enabled(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    // body(iterations) выполняет измеряемый цикл и возвращает объем работы за одну итерацию
+    void run(const std::string& name, const std::function<Work(uint64_t)>& body) {
+        if (!enabled(name)) return;
+
+        uint64_t iterations = 1;
+        for (;;) {
+            auto start = Clock::now();
+            std::clock_t cpu_start = std::clock();
+            Work work = body(iterations);
+            std::clock_t cpu_end = std::clock();
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (seconds >= options_.min_time || iterations >= kMaxIterations) {
+                BenchResult result;
+                result.name = name;
+                result.iterations = iterations;
+                result.real_time_ns = seconds * 1e9 / static_cast<double>(iterations);
+                result.cpu_time_ns = static_cast<double>(cpu_end - cpu_start) / CLOCKS_PER_SEC * 1e9 /
+                                     static_cast<double>(iterations);
+                if (seconds > 0) {
+                    result.items_per_second = static_cast<double>(work.items * iterations) / seconds;
+                    result.bytes_per_second = static_cast<double>(work.bytes * iterations) / seconds;
+                }
+                report(result);
+                results_.push_back(std::move(result));
+                return;
+            }
+
+            double scale = seconds > 0 ? options_.min_time / seconds * 1.4 : 100.0;
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * std::clamp(scale, 2.0, 100.0));
+        }
+    }
+
+    json to_json() const {
+        json benchmarks = json::array();
+        for (const auto& r : results_) {
+            json b = {
+                {"name", r.name},
+                {"run_name", r.name},
+                {"run_type", "iteration"},
+                {"iterations", r.iterations},
+                {"real_time", r.real_time_ns},
+                {"cpu_time", r.cpu_time_ns},
+                {"time_unit", "ns"},
+            };
+            if (r.items_per_second > 0) b["items_per_second"] = r.items_per_second;
+            if (r.bytes_per_second > 0) b["bytes_per_second"] = r.bytes_per_second;
+            benchmarks.push_back(std::move(b));
+        }
+
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        std::ostringstream date;
+        date << std::put_time(std::localtime(&now), "%Y-%m-%dT%H:%M:%S");
+        return {
+            {"context", {
+                {"date", date.str()},
+                {"executable", "sql_db_bench"},
+                {"num_cpus", std::thread::hardware_concurrency()},
+#ifdef NDEBUG
+                {"library_build_type", "release"},
+#else
+                {"library_build_type", "debug"},
+#endif
+            }},
+            {"benchmarks", std::move(benchmarks)},
+        };
+    }
+
+private:
+    static constexpr uint64_t kMaxIterations = 1'000'000'000;
+
+    static void report(const BenchResult& r) {
+        std::cerr << std::left << std::setw(48) << r.name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(1) << r.real_time_ns << " ns"
+                  << std::setw(12) << r.iterations;
+        if (r.items_per_second > 0) std::cerr << "  " << std::setprecision(3) << r.items_per_second / 1e6 << "M items/s";
+        if (r.bytes_per_second > 0) std::cerr << "  " << std::setprecision(1) << r.bytes_per_second / 1048576.0 << " MiB/s";
+        std::cerr << "\n";
+    }
+
+    Options options_;
+    std::vector<BenchResult> results_;
+};
+
+// База с одной сессией; операторы разбираются заранее, чтобы в замер исполнителя не попадал парсер
+class Fixture {
+public:
+    Fixture() {
+        exec("CREATE DATABASE bench");
+        exec("USE bench");
+    }
+
+    static sql::ParseResult parse(const std::string& query) {
+        auto pr = sql::Parser::parse(query);
+        if (!pr.valid) throw std::runtime_error("Parse error in '" + query + "': " + pr.error);
+        return pr;
+    }
+
+    sql::ExecResult exec(const sql::ParseResult& pr) {
+        auto res = sql::Executor::execute(pr, engine_, session_);
+        if (!res.ok) throw std::runtime_error(res.error);
+        return res;
+    }
+
+    sql::ExecResult exec(const std::string& query) { return exec(parse(query)); }
+
+    // Заполняет таблицу строками (id, id % modulo) пакетами многострочных INSERT
+    void fill(const std::string& table, int rows, int modulo) {
+        constexpr int kBatch = 1000;
+        for (int first = 0; first < rows; first += kBatch) {
+            std::string query = "INSERT INTO " + table + " VALUES ";
+            for (int id = first; id < std::min(rows, first + kBatch); ++id) {
+                if (id != first) query += ", ";
+                query += "(" + std::to_string(id) + ", " + std::to_string(id % modulo) + ")";
+            }
+            exec(query);
+        }
+    }
+
+    db::StorageEngine& engine() noexcept { return engine_; }
+
+private:
+    db::StorageEngine engine_;
+    sql::Session session_;
+};
+
+void bench_parser(Runner& runner) {
+    std::string insert_100 = "INSERT INTO t VALUES ";
+    for (int i = 0; i < 100; ++i) {
+        if (i > 0) insert_100 += ", ";
+        insert_100 += "(" + std::to_string(i) + ", \"name" + std::to_string(i) + "\", 1.5, true)";
+    }
+
+    const std::vector<std::pair<std::string, std::string>> statements = {
+        {"create_table", "CREATE TABLE t (id INT, name STR, score FLOAT, active BOOL, pid INT FK p(id))"},
+        {"insert_1", "INSERT INTO t VALUES (1, \"name\", 1.5, true)"},
+        {"insert_100", insert_100},
+        {"select_where", "SELECT id, name FROM t WHERE id = 42 AND active = true"},
+        {"update", "UPDATE t SET score = 2.5, active = false WHERE id = 42"},
+        {"delete", "DELETE FROM t WHERE id = 42 OR name = \"x\""},
+        {"copy", "COPY t FROM 'data.csv' WITH HEADER"},
+        {"prepare", "PREPARE q AS SELECT * FROM t WHERE id = ?"},
+    };
+    for (const auto& [name, query] : statements) {
+        runner.run("parse/" + name, [&query = query](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                sink = sink + sql::Parser::parse(query).valid;
+            }
+            return Work{1, query.size()};
+        });
+    }
+}
+
+void bench_values(Runner& runner) {
+    constexpr size_t kCount = 1024;
+    std::vector<db::Value> ints, strings, mixed;
+    for (size_t i = 0; i < kCount; ++i) {
+        ints.emplace_back(static_cast<int>(i % 16));
+        strings.emplace_back("value_" + std::to_string(i % 16));
+        mixed.emplace_back(i % 2 ? db::Value(db::NullValue{}) : db::Value(static_cast<int>(i)));
+    }
+    const db::Value int_key = 7;
+    const db::Value string_key = std::string("value_7");
+
+    auto compare_all = [](const std::vector<db::Value>& values, const db::Value& key, auto compare) {
+        return [&values, &key, compare](uint64_t iterations) {
+            uint64_t hits = 0;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                for (const auto& value : values) hits += compare(value, key);
+            }
+            sink = sink + hits;
+            return Work{values.size(), 0};
+        };
+    };
+
+    runner.run("value_equals/int", compare_all(ints, int_key, db::value_equals));
+    runner.run("value_equals/string", compare_all(strings, string_key, db::value_equals));
+    runner.run("value_equals/int_or_null", compare_all(mixed, int_key, db::value_equals));
+    runner.run("value_less/int", compare_all(ints, int_key, db::value_less));
+    runner.run("value_less/string", compare_all(strings, string_key, db::value_less));
+
+    auto eq_int = sql::select_compare_kernel(sql::ColumnType::INT, sql::CompareOp::EQ);
+    auto eq_str = sql::select_compare_kernel(sql::ColumnType::STR, sql::CompareOp::EQ);
+    runner.run("kernel_eq/int", compare_all(ints, int_key, eq_int));
+    runner.run("kernel_eq/string", compare_all(strings, string_key, eq_str));
+}
+
+void bench_executor(Runner& runner, const std::vector<int>& sizes) {
+    for (int rows : sizes) {
+        const std::string suffix = "/rows:" + std::to_string(rows);
+        const std::string names[] = {"select/point", "select/full", "update/point", "delete_insert/point", "insert/fk"};
+        bool any = false;
+        for (const auto& name : names) any = any || runner.enabled(name + suffix);
+        if (!any) continue;
+
+        Fixture f;
+        f.exec("CREATE TABLE p (id INT, grp INT)");
+        f.exec("CREATE TABLE c (id INT, pid INT FK p(id))");
+        f.fill("p", rows, 10);
+
+        const std::string key = std::to_string(rows / 2);
+        auto point = Fixture::parse("SELECT * FROM p WHERE id = " + key);
+        runner.run("select/point" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) sink = sink + f.exec(point).result_set.row_count();
+            return Work{static_cast<uint64_t>(rows), 0};
+        });
+
+        auto full = Fixture::parse("SELECT * FROM p");
+        runner.run("select/full" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) sink = sink + f.exec(full).result_set.row_count();
+            return Work{static_cast<uint64_t>(rows), 0};
+        });
+
+        auto update = Fixture::parse("UPDATE p SET grp = 3 WHERE id = " + key);
+        runner.run("update/point" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) f.exec(update);
+            return Work{static_cast<uint64_t>(rows), 0};
+        });
+
+        // Удаление с возвратом строки сохраняет размер таблицы между итерациями
+        auto remove = Fixture::parse("DELETE FROM p WHERE id = " + key);
+        auto restore = Fixture::parse("INSERT INTO p VALUES (" + key + ", 0)");
+        runner.run("delete_insert/point" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                f.exec(remove);
+                f.exec(restore);
+            }
+            return Work{static_cast<uint64_t>(rows), 0};
+        });
+
+        // Проверка внешнего ключа собирает значения родительской таблицы
+        auto insert = Fixture::parse("INSERT INTO c VALUES (1, " + key + ")");
+        runner.run("insert/fk" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) f.exec(insert);
+            return Work{1, 0};
+        });
+    }
+}
+
+// Стоимость проверок ссылочной целостности в зависимости от числа дочерних таблиц
+void bench_fk_fanout(Runner& runner, const std::vector<int>& fanouts) {
+    constexpr int kRows = 1000;
+    for (int fanout : fanouts) {
+        const std::string suffix = "/fanout:" + std::to_string(fanout);
+        if (!runner.enabled("delete/fk_miss" + suffix) && !runner.enabled("update/fk_miss" + suffix)) continue;
+
+        Fixture f;
+        f.exec("CREATE TABLE p (id INT, grp INT)");
+        f.fill("p", kRows, kRows);
+        for (int i = 0; i < fanout; ++i) {
+            const std::string child = "c" + std::to_string(i);
+            f.exec("CREATE TABLE " + child + " (id INT, pid INT FK p(id))");
+            f.fill(child, kRows, kRows);
+        }
+
+        // Условие не находит строк, поэтому замер не меняет данные
+        auto remove = Fixture::parse("DELETE FROM p WHERE id = -1");
+        runner.run("delete/fk_miss" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) f.exec(remove);
+            return Work{static_cast<uint64_t>(kRows * (fanout + 1)), 0};
+        });
+
+        auto update = Fixture::parse("UPDATE p SET id = 5 WHERE id = -1");
+        runner.run("update/fk_miss" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) f.exec(update);
+            return Work{static_cast<uint64_t>(kRows * (fanout + 1)), 0};
+        });
+    }
+}
+
+// Снимок инкрементальный: перед каждым сохранением все таблицы помечаются
+// измененными, чтобы замер включал запись файлов таблиц, а не только манифеста
+void mark_all_dirty(const db::StorageEngine& engine) {
+    for (const auto& [db_name, database] : engine.get_databases()) {
+        for (const auto& [table_name, table] : database.get_tables()) table.mark_dirty();
+    }
+}
+
+// Манифест, запасной манифест и каталог файлов таблиц
+void remove_snapshot(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path + ".prev", ec);
+    std::filesystem::remove_all(path + ".tables", ec);
+}
+
+void bench_persistence(Runner& runner, const std::vector<int>& sizes) {
+    const auto path = (std::filesystem::temp_directory_path() / "sql_db_bench.json").string();
+    for (int rows : sizes) {
+        const std::string suffix = "/rows:" + std::to_string(rows);
+        if (!runner.enabled("save_to_file" + suffix) && !runner.enabled("load_from_file" + suffix)) continue;
+
+        Fixture f;
+        f.exec("CREATE TABLE t (id INT, grp INT, name STR, score FLOAT)");
+        constexpr int kBatch = 1000;
+        for (int first = 0; first < rows; first += kBatch) {
+            std::string query = "INSERT INTO t VALUES ";
+            for (int id = first; id < std::min(rows, first + kBatch); ++id) {
+                if (id != first) query += ", ";
+                query += "(" + std::to_string(id) + ", " + std::to_string(id % 10) + ", \"name" +
+                         std::to_string(id) + "\", " + std::to_string(id) + ".5)";
+            }
+            f.exec(query);
+        }
+
+        // Первое сохранение в пустой каталог: в нем ровно один снимок, его размер и замеряется
+        remove_snapshot(path);
+        if (!db::save_to_file(f.engine(), path)) throw std::runtime_error("Cannot write " + path);
+        uint64_t snapshot_size = std::filesystem::file_size(path);
+        for (const auto& entry : std::filesystem::directory_iterator(path + ".tables")) {
+            snapshot_size += entry.file_size();
+        }
+
+        runner.run("save_to_file" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                mark_all_dirty(f.engine());
+                db::save_to_file(f.engine(), path);
+            }
+            return Work{static_cast<uint64_t>(rows), snapshot_size};
+        });
+
+        runner.run("load_from_file" + suffix, [&](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                db::StorageEngine engine;
+                sink = sink + db::load_from_file(engine, path);
+            }
+            return Work{static_cast<uint64_t>(rows), snapshot_size};
+        });
+    }
+    remove_snapshot(path);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        try {
+            if (arg.rfind("--filter=", 0) == 0) {
+                options.filter = std::string(arg.substr(9));
+            } else if (arg.rfind("--min-time=", 0) == 0) {
+                options.min_time = std::stod(std::string(arg.substr(11)));
+            } else if (arg.rfind("--out=", 0) == 0) {
+                options.out = std::string(arg.substr(6));
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n"
+                          << "Usage: sql_db_bench [--filter=substring] [--min-time=seconds] [--out=file.json]\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value in argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    Runner runner(options);
+    try {
+        bench_parser(runner);
+        bench_values(runner);
+        bench_executor(runner, {1000, 10000, 100000});
+        bench_fk_fanout(runner, {0, 1, 4, 16});
+        bench_persistence(runner, {1000, 100000});
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    const std::string report = runner.to_json().dump(2);
+    if (options.out.empty()) {
+        std::cout << report << "\n";
+    } else {
+        std::ofstream ofs(options.out);
+        if (!ofs) {
+            std::cerr << "Cannot write " << options.out << "\n";
+            return 1;
+        }
+        ofs << report << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,454 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "metrics/Histogram.hpp"
+#include "net/Protocol.hpp"
+
+using json = nlohmann::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Workload : size_t {
+    POINT_READ,
+    INSERT,
+    FK_UPDATE,
+    BULK_DELETE,
+    SCAN,
+    COUNT
+};
+
+constexpr size_t kWorkloadCount = static_cast<size_t>(Workload::COUNT);
+
+struct WorkloadInfo {
+    std::string_view name;
+    std::string_view statement;
+};
+
+// Каждая нагрузка - подготовленный запрос, выполняемый через EXECUTE
+constexpr WorkloadInfo kWorkloads[kWorkloadCount] = {
+    {"point", "SELECT * FROM items WHERE id = ?"},
+    {"insert", "INSERT INTO items VALUES (?, ?, ?)"},
+    {"fk_update", "UPDATE child SET pid = ? WHERE id = ?"},
+    {"bulk_delete", "DELETE FROM items WHERE grp = ?"},
+    {"scan", "SELECT * FROM items"},
+};
+
+// Исходные строки items лежат в группах [0, kBaseGroups); вставленные
+// генератором - в [kBaseGroups, kBaseGroups + kInsertGroups), и только их
+// удаляет bulk_delete, поэтому размер таблицы остается примерно постоянным
+constexpr int kBaseGroups = 100;
+constexpr int kInsertGroups = 10;
+constexpr int kParentRows = 1000;
+constexpr int kChildRows = 1000;
+
+struct Options {
+    short port = 5555;
+    size_t connections = 8;
+    double duration = 10.0;
+    // Суммарная целевая частота запросов; 0 - замкнутый цикл без пауз
+    double rate = 0.0;
+    int rows = 10000;
+    std::vector<double> mix = {50, 30, 10, 5, 5};
+    std::string json_out;
+};
+
+// Задержки в микросекундах. corrected отсчитывается от запланированного
+// момента отправки и учитывает очередь перед медленным ответом (поправка на
+// координированное пропускание), service - от фактической отправки.
+struct Stats {
+    metrics::Histogram corrected[kWorkloadCount];
+    metrics::Histogram service[kWorkloadCount];
+    uint64_t errors[kWorkloadCount] = {};
+    std::string failure;
+
+    void merge(const Stats& other) {
+        for (size_t i = 0; i < kWorkloadCount; ++i) {
+            corrected[i].merge(other.corrected[i]);
+            service[i].merge(other.service[i]);
+            errors[i] += other.errors[i];
+        }
+        if (failure.empty()) failure = other.failure;
+    }
+};
+
+// Блокирующее соединение по framed-протоколу
+class Client {
+public:
+    ~Client() {
+        if (fd_ != -1) ::close(fd_);
+    }
+
+    bool connect(short port, std::string& error) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ == -1) {
+            error = "socket() failed";
+            return false;
+        }
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            error = "Cannot connect to 127.0.0.1:" + std::to_string(port);
+            return false;
+        }
+
+        if (!send_all(net::kHandshake) || !fill(net::kHandshake.size()) ||
+            std::string_view(buffer_).substr(0, net::kHandshake.size()) != net::kHandshake) {
+            error = "Handshake failed";
+            return false;
+        }
+        buffer_.erase(0, net::kHandshake.size());
+        return true;
+    }
+
+    // Отправляет готовый кадр и ждет один ответный
+    bool request(const std::string& frame, net::Frame& response) {
+        if (!send_all(frame)) return false;
+        for (;;) {
+            size_t consumed = 0;
+            switch (net::decode_frame(buffer_, response, consumed)) {
+            case net::DecodeStatus::COMPLETE:
+                buffer_.erase(0, consumed);
+                return true;
+            case net::DecodeStatus::INVALID:
+                return false;
+            case net::DecodeStatus::INCOMPLETE:
+                if (!fill(buffer_.size() + 1)) return false;
+                break;
+            }
+        }
+    }
+
+    bool query(std::string_view text, std::string& error) {
+        std::string frame;
+        if (!net::append_frame(frame, net::MessageType::QUERY, text)) {
+            error = "Query is too large";
+            return false;
+        }
+        net::Frame response;
+        if (!request(frame, response)) {
+            error = "Connection lost";
+            return false;
+        }
+        if (response.type == net::MessageType::ERROR) {
+            error = response.payload;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool send_all(std::string_view data) {
+        while (!data.empty()) {
+            ssize_t n = ::send(fd_, data.data(), data.size(), MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            data.remove_prefix(static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    bool fill(size_t size) {
+        char chunk[64 * 1024];
+        while (buffer_.size() < size) {
+            ssize_t n = ::recv(fd_, chunk, sizeof(chunk), 0);
+            if (n <= 0) return false;
+            buffer_.append(chunk, static_cast<size_t>(n));
+        }
+        return true;
+    }
+
+    int fd_ = -1;
+    std::string buffer_;
+};
+
+bool prepare_schema(const Options& options, std::string& error) {
+    Client client;
+    if (!client.connect(options.port, error)) return false;
+
+    std::string ignored;
+    client.query("DROP DATABASE loadgen", ignored);
+    if (!client.query("CREATE DATABASE loadgen", error) || !client.query("USE loadgen", error) ||
+        !client.query("CREATE TABLE items (id INT, grp INT, payload STR)", error) ||
+        !client.query("CREATE TABLE parent (id INT, name STR)", error) ||
+        !client.query("CREATE TABLE child (id INT, pid INT FK parent(id))", error)) {
+        return false;
+    }
+
+    auto fill = [&](const std::string& table, int rows, auto make_row) {
+        constexpr int kBatch = 1000;
+        for (int first = 0; first < rows; first += kBatch) {
+            std::string query = "INSERT INTO " + table + " VALUES ";
+            for (int id = first; id < std::min(rows, first + kBatch); ++id) {
+                if (id != first) query += ", ";
+                query += make_row(id);
+            }
+            if (!client.query(query, error)) return false;
+        }
+        return true;
+    };
+    return fill("items", options.rows, [](int id) {
+               return "(" + std::to_string(id) + ", " + std::to_string(id % kBaseGroups) + ", \"payload" +
+                      std::to_string(id) + "\")";
+           }) &&
+           fill("parent", kParentRows, [](int id) {
+               return "(" + std::to_string(id) + ", \"parent" + std::to_string(id) + "\")";
+           }) &&
+           fill("child", kChildRows, [](int id) {
+               return "(" + std::to_string(id) + ", " + std::to_string(id % kParentRows) + ")";
+           });
+}
+
+void run_connection(const Options& options, size_t index, Clock::time_point start, Clock::time_point end, Stats& stats) {
+    Client client;
+    std::string error;
+    if (!client.connect(options.port, error) || !client.query("USE loadgen", error)) {
+        stats.failure = error;
+        return;
+    }
+    for (size_t i = 0; i < kWorkloadCount; ++i) {
+        std::string frame;
+        net::Frame response;
+        if (!net::append_prepare(frame, {std::string(kWorkloads[i].name), std::string(kWorkloads[i].statement)}) ||
+            !client.request(frame, response) || response.type == net::MessageType::ERROR) {
+            stats.failure = "PREPARE " + std::string(kWorkloads[i].name) + " failed: " + response.payload;
+            return;
+        }
+    }
+
+    std::mt19937_64 rng(0x9e3779b97f4a7c15ULL ^ index);
+    std::discrete_distribution<size_t> pick(options.mix.begin(), options.mix.end());
+    std::uniform_int_distribution<int> item_id(0, std::max(0, options.rows - 1));
+    std::uniform_int_distribution<int> parent_id(0, kParentRows - 1);
+    std::uniform_int_distribution<int> child_id(0, kChildRows - 1);
+    std::uniform_int_distribution<int> insert_group(kBaseGroups, kBaseGroups + kInsertGroups - 1);
+    int next_id = options.rows + static_cast<int>(index) * 10'000'000;
+
+    // В открытом цикле соединение отправляет запросы по расписанию с шагом interval
+    const bool open_loop = options.rate > 0;
+    const auto interval = open_loop
+        ? std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double>(static_cast<double>(options.connections) / options.rate))
+        : Clock::duration::zero();
+    auto scheduled = start + interval * static_cast<int64_t>(index) / static_cast<int64_t>(options.connections);
+
+    std::string frame;
+    net::Frame response;
+    net::ExecuteRequest request;
+    for (;;) {
+        // В открытом цикле отправляется каждый запрос, назначенный до end, даже если
+        // сервер задержал его за end: иначе пропадает именно хвост задержек
+        if (open_loop) {
+            if (scheduled >= end) break;
+            std::this_thread::sleep_until(scheduled);
+        }
+        const auto sent = Clock::now();
+        if (!open_loop) {
+            if (sent >= end) break;
+            scheduled = sent;
+        }
+
+        const size_t workload = pick(rng);
+        request.name = kWorkloads[workload].name;
+        request.params.clear();
+        switch (static_cast<Workload>(workload)) {
+        case Workload::POINT_READ:
+            request.params = {item_id(rng)};
+            break;
+        case Workload::INSERT: {
+            int id = next_id++;
+            request.params = {id, insert_group(rng), "payload" + std::to_string(id)};
+            break;
+        }
+        case Workload::FK_UPDATE:
+            request.params = {parent_id(rng), child_id(rng)};
+            break;
+        case Workload::BULK_DELETE:
+            request.params = {insert_group(rng)};
+            break;
+        default:
+            break;
+        }
+
+        frame.clear();
+        if (!net::append_execute(frame, request) || !client.request(frame, response)) {
+            stats.failure = "Connection lost";
+            return;
+        }
+        const auto done = Clock::now();
+        if (response.type == net::MessageType::ERROR) stats.errors[workload]++;
+
+        using std::chrono::microseconds;
+        stats.corrected[workload].record(std::chrono::duration_cast<microseconds>(done - scheduled).count());
+        stats.service[workload].record(std::chrono::duration_cast<microseconds>(done - sent).count());
+        if (open_loop) scheduled += interval;
+    }
+}
+
+json latency_json(const metrics::Histogram& h) {
+    return {
+        {"count", h.count()},
+        {"mean_us", h.mean()},
+        {"p50_us", h.percentile(50)},
+        {"p99_us", h.percentile(99)},
+        {"p999_us", h.percentile(99.9)},
+        {"max_us", h.max()},
+    };
+}
+
+void print_row(std::string_view name, const metrics::Histogram& h, double seconds, uint64_t errors) {
+    std::cout << std::left << std::setw(14) << name << std::right
+              << std::setw(10) << h.count()
+              << std::setw(12) << std::fixed << std::setprecision(1) << static_cast<double>(h.count()) / seconds
+              << std::setw(10) << h.percentile(50)
+              << std::setw(10) << h.percentile(99)
+              << std::setw(10) << h.percentile(99.9)
+              << std::setw(10) << h.max()
+              << std::setw(8) << errors << "\n";
+}
+
+bool parse_mix(std::string_view text, std::vector<double>& mix) {
+    mix.assign(kWorkloadCount, 0.0);
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view item = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+
+        size_t eq = item.find('=');
+        if (eq == std::string_view::npos) return false;
+        auto it = std::find_if(std::begin(kWorkloads), std::end(kWorkloads),
+                               [name = item.substr(0, eq)](const WorkloadInfo& w) { return w.name == name; });
+        if (it == std::end(kWorkloads)) return false;
+        mix[static_cast<size_t>(it - std::begin(kWorkloads))] = std::stod(std::string(item.substr(eq + 1)));
+    }
+    return std::any_of(mix.begin(), mix.end(), [](double w) { return w > 0; });
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        try {
+            if (arg.rfind("--port=", 0) == 0) {
+                options.port = static_cast<short>(std::stoi(std::string(arg.substr(7))));
+            } else if (arg.rfind("--connections=", 0) == 0) {
+                options.connections = std::max<size_t>(1, std::stoul(std::string(arg.substr(14))));
+            } else if (arg.rfind("--duration=", 0) == 0) {
+                options.duration = std::stod(std::string(arg.substr(11)));
+            } else if (arg.rfind("--rate=", 0) == 0) {
+                options.rate = std::stod(std::string(arg.substr(7)));
+            } else if (arg.rfind("--rows=", 0) == 0) {
+                options.rows = std::stoi(std::string(arg.substr(7)));
+            } else if (arg.rfind("--mix=", 0) == 0) {
+                if (!parse_mix(arg.substr(6), options.mix)) throw std::invalid_argument("mix");
+            } else if (arg.rfind("--json=", 0) == 0) {
+                options.json_out = std::string(arg.substr(7));
+            } else {
+                std::cerr << "Unknown argument: " << arg << "\n"
+                          << "Usage: sql_db_loadgen [--port=5555] [--connections=8] [--duration=10] [--rate=ops_per_sec]\n"
+                          << "                      [--rows=10000] [--mix=point=50,insert=30,fk_update=10,bulk_delete=5,scan=5]\n"
+                          << "                      [--json=file]\n";
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value in argument: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::string error;
+    if (!prepare_schema(options, error)) {
+        std::cerr << "Setup failed: " << error << "\n";
+        return 1;
+    }
+
+    std::vector<std::unique_ptr<Stats>> per_connection;
+    std::vector<std::thread> threads;
+    const auto start = Clock::now() + std::chrono::milliseconds(100);
+    const auto end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    for (size_t i = 0; i < options.connections; ++i) {
+        per_connection.push_back(std::make_unique<Stats>());
+        threads.emplace_back(run_connection, std::cref(options), i, start, end, std::ref(*per_connection.back()));
+    }
+    for (auto& t : threads) t.join();
+    const double seconds = std::chrono::duration<double>(std::max(Clock::now(), end) - start).count();
+
+    auto stats = std::make_unique<Stats>();
+    for (const auto& s : per_connection) stats->merge(*s);
+    if (!stats->failure.empty()) std::cerr << "Warning: " << stats->failure << "\n";
+
+    metrics::Histogram total_corrected, total_service;
+    uint64_t total_errors = 0;
+    for (size_t i = 0; i < kWorkloadCount; ++i) {
+        total_corrected.merge(stats->corrected[i]);
+        total_service.merge(stats->service[i]);
+        total_errors += stats->errors[i];
+    }
+
+    std::cout << options.connections << " connection(s), " << std::fixed << std::setprecision(1) << seconds << " s, "
+              << (options.rate > 0 ? "open loop at " + std::to_string(static_cast<uint64_t>(options.rate)) + " ops/s"
+                                   : std::string("closed loop"))
+              << "\nLatency in microseconds"
+              << (options.rate > 0 ? ", measured from the scheduled send time" : "") << "\n\n"
+              << std::left << std::setw(14) << "workload" << std::right << std::setw(10) << "ops" << std::setw(12)
+              << "ops/s" << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+              << std::setw(10) << "max" << std::setw(8) << "errors" << "\n";
+    for (size_t i = 0; i < kWorkloadCount; ++i) {
+        if (stats->corrected[i].count()) print_row(kWorkloads[i].name, stats->corrected[i], seconds, stats->errors[i]);
+    }
+    print_row("total", total_corrected, seconds, total_errors);
+    if (options.rate > 0) {
+        std::cout << "\nService time (from the actual send):\n";
+        print_row("total", total_service, seconds, total_errors);
+    }
+
+    if (!options.json_out.empty()) {
+        json report = {
+            {"connections", options.connections},
+            {"duration_s", seconds},
+            {"target_rate", options.rate},
+            {"throughput", static_cast<double>(total_corrected.count()) / seconds},
+            {"errors", total_errors},
+            {"latency", latency_json(total_corrected)},
+            {"service_time", latency_json(total_service)},
+        };
+        for (size_t i = 0; i < kWorkloadCount; ++i) {
+            if (!stats->corrected[i].count()) continue;
+            report["workloads"][std::string(kWorkloads[i].name)] = {
+                {"errors", stats->errors[i]},
+                {"latency", latency_json(stats->corrected[i])},
+                {"service_time", latency_json(stats->service[i])},
+            };
+        }
+        std::ofstream ofs(options.json_out);
+        if (!ofs) {
+            std::cerr << "Cannot write " << options.json_out << "\n";
+            return 1;
+        }
+        ofs << report.dump(2) << "\n";
+    }
+    return stats->failure.empty() ? 0 : 1;
+}